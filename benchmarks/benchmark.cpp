@@ -0,0 +1,604 @@
+// Headless render benchmarks.
+//
+// Runs on the offscreen platform against the PDFs in slides/ and a generated
+// stress deck, and writes one JSON document with per-page timings:
+//   - cold / warm page renders at 1080p, 4K and 8K
+//   - split mode (slide half, notes half) against a full-page render
+//   - the console's next-slide preview
+//   - time to first slide when opening a deck in the full window
+//   - full updateViews() latency: page turn until every view shows final rasters
+//   - frame pacing of animated transitions on a 4K audience window, and how many
+//     slide invalidations were coalesced into each render
+//   - full-text search: background index build and per-keystroke query latency
+//   - slide sorter: time to open the grid and per-frame cost while scrolling it
+//   - disk cache: first slide of a deck opened for the first time vs. reopened
+//   - slide package: compile time and size at 1080p, and page turns played from it
+//   - batch export (--render-out): images/s with one worker and with one per core
+//
+//   bin/benchmark [--deck file.pdf]... [--stress-pages 500] [--sample 40] [--output results.json]
+
+#include <QApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QPdfBookmarkModel>
+#include <QPdfDocument>
+#include <QPdfWriter>
+#include <QRandomGenerator>
+#include <QScrollBar>
+#include <QSettings>
+#include <QSaveFile>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QThreadPool>
+#include <QTimer>
+#include <QtMath>
+#include <algorithm>
+#include <cstdio>
+#include <functional>
+#include "batchrenderer.h"
+#include "documentloader.h"
+#include "mainwindow.h"
+#include "presentationdisplay.h"
+#include "renderprofiler.h"
+#include "searchindex.h"
+#include "slidepackage.h"
+#include "sliderenderer.h"
+#include "slidesorter.h"
+
+namespace {
+const int kTimeoutMs = 60000;
+
+struct Resolution {
+    const char *name;
+    QSize size;
+};
+const Resolution kResolutions[] = {
+    { "1080p", QSize(1920, 1080) },
+    { "4K", QSize(3840, 2160) },
+    { "8K", QSize(7680, 4320) },
+};
+// Roughly the console's next-slide pane
+const QSize kPreviewSize(480, 270);
+
+bool waitUntil(const std::function<bool()> &done, int timeoutMs = kTimeoutMs)
+{
+    QElapsedTimer timer;
+    timer.start();
+    QTimer tick; // Wakes the event loop so the timeout is noticed
+    tick.start(10);
+    while (!done()) {
+        if (timer.elapsed() > timeoutMs) return false;
+        QCoreApplication::processEvents(QEventLoop::WaitForMoreEvents);
+    }
+    return true;
+}
+
+// Negative samples are timeouts
+QJsonObject summarize(QList<double> ms)
+{
+    QJsonObject o;
+    const qsizetype timeouts = ms.removeIf([](double v) { return v < 0; });
+    o["count"] = int(ms.size());
+    if (timeouts) o["timeouts"] = int(timeouts);
+    if (ms.isEmpty()) return o;
+    std::sort(ms.begin(), ms.end());
+    double sum = 0;
+    for (double v : ms) sum += v;
+    auto at = [&](double q) { return ms[qBound(0, int(q * ms.size() + 0.5) - 1, int(ms.size()) - 1)]; };
+    o["meanMs"] = sum / ms.size();
+    o["p50Ms"] = at(0.50);
+    o["p99Ms"] = at(0.99);
+    o["minMs"] = ms.first();
+    o["maxMs"] = ms.last();
+    return o;
+}
+
+// Evenly spread pages, so huge decks stay affordable at 8K
+QList<int> samplePages(int pageCount, int sample)
+{
+    QList<int> pages;
+    int n = qMin(pageCount, sample);
+    for (int i = 0; i < n; ++i) pages.append(int(qint64(i) * pageCount / n));
+    return pages;
+}
+
+// A deck that looks like real slides: title, bullets, vector art, and a photo every few pages
+bool writeStressDeck(const QString &filePath, int pages)
+{
+    QPdfWriter writer(filePath);
+    writer.setPageSize(QPageSize(QSizeF(254, 142.875), QPageSize::Millimeter)); // 16:9 Beamer
+    writer.setPageMargins(QMarginsF(0, 0, 0, 0));
+    writer.setResolution(144);
+    writer.setTitle("my_presenter stress deck");
+
+    QImage photo(640, 480, QImage::Format_RGB32);
+    QRandomGenerator rng(42);
+    for (int y = 0; y < photo.height(); ++y) {
+        QRgb *line = reinterpret_cast<QRgb *>(photo.scanLine(y));
+        for (int x = 0; x < photo.width(); ++x) line[x] = qRgb((x + y) % 256, (x * 3) % 256, rng.bounded(256));
+    }
+
+    QPainter p(&writer);
+    if (!p.isActive()) return false;
+    const QRect page = p.viewport();
+    for (int i = 0; i < pages; ++i) {
+        if (i > 0) writer.newPage();
+
+        QLinearGradient background(page.topLeft(), page.bottomRight());
+        background.setColorAt(0, QColor(235, 240, 250));
+        background.setColorAt(1, QColor(200, 210, 235));
+        p.fillRect(page, background);
+
+        QFont title("Sans", 28, QFont::Bold);
+        p.setFont(title);
+        p.setPen(QColor(20, 40, 90));
+        p.drawText(page.adjusted(60, 40, -60, 0), Qt::AlignTop | Qt::AlignLeft, QString("Slide %1: Stress Test").arg(i + 1));
+
+        p.setFont(QFont("Sans", 16));
+        p.setPen(Qt::black);
+        for (int b = 0; b < 6; ++b) {
+            p.drawText(QPoint(90, 200 + b * 60), QString("- Bullet point %1 with some representative text, figures and %2%")
+                                                     .arg(b + 1).arg(rng.bounded(100)));
+        }
+
+        // Vector chart
+        p.setRenderHint(QPainter::Antialiasing);
+        QRect chart(page.width() / 2 + 40, 180, page.width() / 2 - 120, page.height() - 260);
+        p.setPen(QPen(Qt::darkGray, 2));
+        p.drawRect(chart);
+        QPolygonF series;
+        for (int x = 0; x <= 200; ++x) {
+            series << QPointF(chart.left() + chart.width() * x / 200.0,
+                              chart.center().y() + chart.height() * 0.4 * qSin(x / 12.0 + i));
+        }
+        p.setPen(QPen(QColor(200, 60, 40), 3));
+        p.drawPolyline(series);
+        for (int c = 0; c < 40; ++c) {
+            p.setBrush(QColor::fromHsv((c * 9 + i) % 360, 160, 220, 160));
+            p.setPen(Qt::NoPen);
+            p.drawEllipse(QPointF(chart.left() + rng.bounded(chart.width()), chart.top() + rng.bounded(chart.height())), 12, 12);
+        }
+        p.setBrush(Qt::NoBrush);
+
+        if (i % 5 == 0) p.drawImage(QRect(60, page.height() - 300, 320, 240), photo);
+    }
+    return p.end();
+}
+
+class Benchmark
+{
+public:
+    explicit Benchmark(int sample) : sample(sample) {}
+
+    QJsonObject runDeck(const QString &filePath)
+    {
+        QJsonObject result;
+        result["name"] = QFileInfo(filePath).fileName();
+        result["path"] = filePath;
+
+        SlideRenderer renderer;
+        renderer.openDocument(filePath);
+        if (!waitUntil([&] { return renderer.isReady(); })) {
+            result["error"] = "document did not load";
+            return result;
+        }
+        result["pages"] = renderer.pageCount();
+        result["workers"] = renderer.workerCount();
+
+        // Nothing may be served from the cache: every request is a real render
+        renderer.setCacheBudget(0);
+        const QList<int> pages = samplePages(renderer.pageCount(), sample);
+
+        QJsonObject render;
+        for (const Resolution &res : kResolutions) {
+            QList<double> cold, warm;
+            for (int page : pages) {
+                RenderRequest request = RenderRequest::fitted(page, renderer.pagePointSize(page), res.size);
+                cold.append(renderOnce(renderer, request));
+                warm.append(renderOnce(renderer, request)); // Same page again: PDFium has it parsed
+            }
+            render[res.name] = QJsonObject{{"cold", summarize(cold)}, {"warm", summarize(warm)}};
+            qInfo("  %-6s cold p50 %.1f ms, warm p50 %.1f ms", res.name,
+                  render[res.name].toObject()["cold"].toObject()["p50Ms"].toDouble(),
+                  render[res.name].toObject()["warm"].toObject()["p50Ms"].toDouble());
+        }
+        result["render"] = render;
+
+        // Split mode rasterizes one half of a Beamer notes page per view
+        {
+            const QSize target = kResolutions[0].size;
+            QList<double> full, slide, notes;
+            for (int page : pages) {
+                QSizeF size = renderer.pagePointSize(page);
+                full.append(renderOnce(renderer, RenderRequest::fitted(page, size, target)));
+                slide.append(renderOnce(renderer, RenderRequest::fitted(page, size, target, QRectF(0, 0, 0.5, 1))));
+                notes.append(renderOnce(renderer, RenderRequest::fitted(page, size, target, QRectF(0.5, 0, 0.5, 1))));
+            }
+            result["split"] = QJsonObject{{"fullPage", summarize(full)}, {"slideHalf", summarize(slide)},
+                                          {"notesHalf", summarize(notes)}};
+        }
+
+        {
+            QList<double> preview;
+            for (int page : pages) {
+                preview.append(renderOnce(renderer, RenderRequest::fitted(page, renderer.pagePointSize(page), kPreviewSize)));
+            }
+            result["nextPreview"] = summarize(preview);
+        }
+
+        result["updateViews"] = runUpdateViews(filePath);
+        result["transitions"] = runTransitions(filePath);
+        result["search"] = runSearch(filePath);
+        result["slideSorter"] = runSlideSorter(filePath);
+        result["diskCache"] = runDiskCache(filePath);
+        result["package"] = runPackage(filePath);
+        result["batchExport"] = runBatchExport(filePath, pages);
+        return result;
+    }
+
+    // Exports the sampled pages at 1080p with one worker, then one per core. QtPdf
+    // serializes rendering, so the speedup shows what overlapping encoding buys.
+    QJsonObject runBatchExport(const QString &filePath, const QList<int> &pages)
+    {
+        QStringList spec;
+        for (int page : pages) spec.append(QString::number(page + 1));
+
+        auto imagesPerSecond = [&](int jobs) -> double {
+            QTemporaryDir outputDir;
+            if (!outputDir.isValid()) return -1;
+            BatchRenderOptions options;
+            options.sourcePath = filePath;
+            options.outputDir = outputDir.path();
+            options.pages = spec.join(',');
+            options.sizes = { kResolutions[0].size };
+            options.jobs = jobs;
+            const qint64 start = RenderProfiler::now();
+            if (BatchRenderer(options).run() != 0) return -1;
+            return pages.size() / ((RenderProfiler::now() - start) / 1e9);
+        };
+        const int cores = QThread::idealThreadCount();
+        const double single = imagesPerSecond(1);
+        const double parallel = imagesPerSecond(cores);
+        if (single <= 0 || parallel <= 0) return QJsonObject{{"error", "export failed"}};
+        qInfo("  batch export %.1f images/s on 1 worker, %.1f on %d (x%.2f)", single, parallel, cores,
+              parallel / single);
+        return QJsonObject{{"images", int(pages.size())}, {"singleWorkerImagesPerSecond", single},
+                           {"workers", cores}, {"imagesPerSecond", parallel}, {"speedup", parallel / single}};
+    }
+
+private:
+    double renderOnce(SlideRenderer &renderer, const RenderRequest &request)
+    {
+        quint64 ticket = 0;
+        bool done = false;
+        bool rendered = false;
+        QMetaObject::Connection connection = QObject::connect(&renderer, &SlideRenderer::imageReady,
+            [&](quint64 t, const RenderRequest &, const QImage &image) {
+                if (t == ticket) {
+                    done = true;
+                    rendered = !image.isNull();
+                }
+            });
+        const qint64 start = RenderProfiler::now();
+        ticket = renderer.requestRender(request);
+        bool ok = ticket && waitUntil([&] { return done; }) && rendered;
+        QObject::disconnect(connection);
+        return ok ? (RenderProfiler::now() - start) / 1e6 : -1;
+    }
+
+    // Drives the real window: first pass with cold caches, second pass over the same pages warm
+    QJsonObject runUpdateViews(const QString &filePath)
+    {
+        const qint64 openStart = RenderProfiler::now();
+        MainWindow window(nullptr, filePath);
+        window.resize(1280, 800);
+        window.show();
+
+        int settledPage = -1;
+        bool started = false;
+        QObject::connect(&window, &MainWindow::viewsSettled, [&](int page) { settledPage = page; });
+        QObject::connect(&window, &MainWindow::startupComplete, [&] { started = true; });
+        if (!waitUntil([&] { return settledPage == 0; })) return QJsonObject{{"error", "first page never settled"}};
+        // Window construction until every view shows slide 1
+        const double firstSlideMs = (RenderProfiler::now() - openStart) / 1e6;
+        // Page turns need the deferred panels (timer, hotkeys) in place
+        if (!waitUntil([&] { return started; })) return QJsonObject{{"error", "startup never completed"}};
+        qInfo("  first slide after %.1f ms", firstSlideMs);
+
+        auto turn = [&](const char *slot, int expectedPage) {
+            settledPage = -1;
+            const qint64 start = RenderProfiler::now();
+            QMetaObject::invokeMethod(&window, slot, Qt::DirectConnection);
+            bool ok = waitUntil([&] { return settledPage == expectedPage; });
+            return ok ? (RenderProfiler::now() - start) / 1e6 : -1;
+        };
+
+        const int pageCount = window.findChild<SlideRenderer *>()->pageCount();
+        const int turns = qMin(sample, 30);
+        QList<double> cold, warm;
+        int page = 0;
+        for (int i = 0; i < turns && page + 1 < pageCount; ++i) {
+            cold.append(turn("nextSlide", ++page));
+        }
+        turn("firstSlide", 0);
+        for (int target = 1; target <= page; ++target) {
+            warm.append(turn("nextSlide", target));
+        }
+        window.close();
+        return QJsonObject{{"firstSlideMs", firstSlideMs}, {"cold", summarize(cold)}, {"warm", summarize(warm)}};
+    }
+
+    // Animates between pre-rendered 4K slides and reports the frame pacing per style
+    QJsonObject runTransitions(const QString &filePath)
+    {
+        SlideRenderer renderer;
+        renderer.openDocument(filePath);
+        if (!waitUntil([&] { return renderer.isReady(); })) return QJsonObject{{"error", "document did not load"}};
+
+        PresentationDisplay display;
+        display.setRenderer(&renderer);
+        display.resize(kResolutions[1].size);
+        display.show();
+
+        int readyPage = -1;
+        QObject::connect(&display, &PresentationDisplay::slideReady, [&](int page) { readyPage = page; });
+        auto show = [&](int page) {
+            display.setPage(page);
+            return waitUntil([&] { return readyPage == page && !display.isTransitioning(); });
+        };
+
+        // Transitions only animate cached rasters, so visit every page once first
+        const int pages = qMin(renderer.pageCount(), 6);
+        for (int page = 0; page < pages; ++page) {
+            if (!show(page)) return QJsonObject{{"error", "slides never rendered"}};
+        }
+
+        const struct { const char *name; PresentationDisplay::TransitionStyle style; } styles[] = {
+            { "crossfade", PresentationDisplay::Crossfade },
+            { "push", PresentationDisplay::Push },
+            { "cover", PresentationDisplay::Cover },
+        };
+        QJsonObject result;
+        for (const auto &s : styles) {
+            display.setTransition(s.style);
+            int frames = 0, dropped = 0;
+            double worst = 0, budget = 0;
+            for (int i = 1; i < pages * 2; ++i) {
+                const int page = i < pages ? i : pages * 2 - 1 - i; // There and back again
+                if (!show(page)) break;
+                PresentationDisplay::TransitionStats t = display.transitionStats();
+                frames += t.frames;
+                dropped += t.droppedFrames;
+                worst = qMax(worst, double(t.worstFrameMs));
+                budget = t.frameBudgetMs;
+            }
+            result[s.name] = QJsonObject{{"frames", frames}, {"droppedFrames", dropped},
+                                         {"worstFrameMs", worst}, {"frameBudgetMs", budget}};
+            qInfo("  %-9s %d frames, %d dropped, worst %.1f ms", s.name, frames, dropped, worst);
+        }
+        // Every page turn, resize and mode change invalidates; coalescing should leave about one render each
+        const PresentationDisplay::RenderStats refresh = display.renderStats();
+        result["refresh"] = QJsonObject{{"invalidations", qint64(refresh.invalidations)},
+                                        {"renders", qint64(refresh.renders)}};
+        qInfo("  %llu invalidations, %llu renders", refresh.invalidations, refresh.renders);
+        return result;
+    }
+
+    // Builds the index the way the console does, then types queries one keystroke at a time
+    QJsonObject runSearch(const QString &filePath)
+    {
+        DocumentLoader loader;
+        SearchIndex index;
+        bool indexed = false;
+        QObject::connect(&loader, &DocumentLoader::loaded, [](QPdfDocument *document, QPdfBookmarkModel *bookmarks) {
+            delete bookmarks;
+            delete document;
+        });
+        QObject::connect(&loader, &DocumentLoader::indexed, [&](const SearchIndex &result) {
+            index = result;
+            indexed = true;
+        });
+        const qint64 start = RenderProfiler::now();
+        loader.load(filePath);
+        if (!waitUntil([&] { return indexed; })) return QJsonObject{{"error", "index was not built"}};
+        const double buildMs = (RenderProfiler::now() - start) / 1e6;
+
+        QList<double> keystrokes;
+        int hits = 0;
+        for (const QString &query : { QString("slide"), QString("bullet point"), QString("representative text figures"),
+                                      QString("the"), QString("zzz") }) {
+            for (int length = 1; length <= query.size(); ++length) {
+                const qint64 t = RenderProfiler::now();
+                hits += index.search(query.left(length)).size();
+                keystrokes.append((RenderProfiler::now() - t) / 1e6);
+            }
+        }
+        QJsonObject keys = summarize(keystrokes);
+        qInfo("  search index %d pages in %.0f ms, keystroke p99 %.2f ms", index.pageCount(), buildMs,
+              keys["p99Ms"].toDouble());
+        return QJsonObject{{"indexBuildMs", buildMs}, {"pages", index.pageCount()}, {"keystroke", keys}, {"hits", hits}};
+    }
+
+    // Opens the grid on a 1080p console and scrolls through the whole deck
+    QJsonObject runSlideSorter(const QString &filePath)
+    {
+        SlideRenderer renderer;
+        renderer.openDocument(filePath);
+        if (!waitUntil([&] { return renderer.isReady(); })) return QJsonObject{{"error", "document did not load"}};
+
+        qint64 start = RenderProfiler::now();
+        SlideSorter sorter(&renderer);
+        sorter.resize(kResolutions[0].size);
+        sorter.show();
+        sorter.showPage(0);
+        sorter.repaint();
+        const double openMs = (RenderProfiler::now() - start) / 1e6;
+
+        // One step per frame, a third of the viewport at a time; thumbnails land in between
+        QList<double> frames;
+        QScrollBar *bar = sorter.verticalScrollBar();
+        const int step = qMax(1, sorter.viewport()->height() / 3);
+        for (int value = 0; value <= bar->maximum(); value += step) {
+            start = RenderProfiler::now();
+            bar->setValue(value);
+            sorter.repaint();
+            frames.append((RenderProfiler::now() - start) / 1e6);
+            QCoreApplication::processEvents();
+        }
+        QJsonObject scroll = summarize(frames);
+        qInfo("  slide sorter open %.1f ms, scroll frame p99 %.2f ms", openMs, scroll["p99Ms"].toDouble());
+        return QJsonObject{{"openMs", openMs}, {"scrollFrame", scroll}};
+    }
+
+    // Opens the deck twice with a fresh disk cache: the second open is a rehearsal reopening it
+    QJsonObject runDiskCache(const QString &filePath)
+    {
+        QTemporaryDir cacheDir;
+        if (!cacheDir.isValid()) return QJsonObject{{"error", "no temporary directory"}};
+
+        auto firstSlide = [&]() -> double {
+            const qint64 start = RenderProfiler::now();
+            SlideRenderer renderer;
+            renderer.setDiskCache(cacheDir.path(), qint64(1024) * 1024 * 1024);
+            renderer.openDocument(filePath);
+            if (!waitUntil([&] { return renderer.isReady(); })) return -1;
+            const double ms = renderOnce(renderer, RenderRequest::fitted(0, renderer.pagePointSize(0), kResolutions[0].size));
+            if (ms < 0) return -1;
+            const double total = (RenderProfiler::now() - start) / 1e6;
+            // A new deck is hashed in the background; its first rasters are written once that lands
+            waitUntil([&] { return !renderer.contentKey().isEmpty(); });
+            QThreadPool::globalInstance()->waitForDone(); // Let the disk writes land
+            return total;
+        };
+        const double cold = firstSlide();
+        const double warm = firstSlide();
+        qInfo("  first slide %.1f ms, reopened from disk cache %.1f ms", cold, warm);
+        return QJsonObject{{"firstSlideMs", cold}, {"reopenedFirstSlideMs", warm}};
+    }
+
+    // Compiles the deck at 1080p, then turns pages on an audience window playing from the package
+    QJsonObject runPackage(const QString &filePath)
+    {
+        QTemporaryDir dir;
+        if (!dir.isValid()) return QJsonObject{{"error", "no temporary directory"}};
+        const QString packagePath = dir.filePath("deck.mpk");
+
+        const qint64 start = RenderProfiler::now();
+        if (SlidePackage::build(filePath, packagePath, kResolutions[0].size) != 0) {
+            return QJsonObject{{"error", "compile failed"}};
+        }
+        const double compileMs = (RenderProfiler::now() - start) / 1e6;
+
+        SlideRenderer renderer;
+        renderer.openDocument(filePath);
+        SlidePackage package;
+        if (!package.open(packagePath) || !waitUntil([&] { return renderer.isReady(); })) {
+            return QJsonObject{{"error", "package did not open"}};
+        }
+
+        PresentationDisplay display;
+        display.setRenderer(&renderer);
+        display.setPackage(&package);
+        display.resize(kResolutions[0].size);
+        display.show();
+
+        int readyPage = -1;
+        QObject::connect(&display, &PresentationDisplay::slideReady, [&](int page) { readyPage = page; });
+        QList<double> turns;
+        for (int page : samplePages(package.pageCount(), sample)) {
+            const qint64 turnStart = RenderProfiler::now();
+            display.setPage(page);
+            display.repaint();
+            const bool ok = waitUntil([&] { return readyPage == page; });
+            turns.append(ok ? (RenderProfiler::now() - turnStart) / 1e6 : -1);
+        }
+        display.close();
+
+        QJsonObject turn = summarize(turns);
+        qInfo("  package compiled in %.1f ms (%.0f MiB), page turn p99 %.2f ms", compileMs,
+              QFileInfo(packagePath).size() / (1024.0 * 1024.0), turn["p99Ms"].toDouble());
+        return QJsonObject{{"compileMs", compileMs}, {"bytes", QFileInfo(packagePath).size()}, {"pageTurn", turn}};
+    }
+
+    int sample;
+};
+}
+
+int main(int argc, char *argv[])
+{
+    // Headless unless explicitly asked otherwise
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+    QCoreApplication::setApplicationName("my_presenter-benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless page-turn and render benchmarks");
+    parser.addHelpOption();
+    QCommandLineOption deckOption("deck", "Benchmark this PDF (repeatable). Defaults to the PDFs in slides/.", "file");
+    QCommandLineOption stressOption("stress-pages", "Pages of the generated stress deck; 0 skips it.", "count", "500");
+    QCommandLineOption sampleOption("sample", "Pages measured per deck and resolution.", "count", "40");
+    QCommandLineOption outputOption("output", "Write the JSON results here instead of stdout.", "file");
+    parser.addOptions({ deckOption, stressOption, sampleOption, outputOption });
+    parser.process(app);
+
+    QStringList decks;
+    for (const QString &deck : parser.values(deckOption)) decks.append(QFileInfo(deck).absoluteFilePath());
+    if (decks.isEmpty()) {
+        QDir slides(SLIDES_DIR);
+        for (const QFileInfo &fi : slides.entryInfoList({ "*.pdf" }, QDir::Files, QDir::Name)) {
+            decks.append(fi.absoluteFilePath());
+        }
+        if (decks.isEmpty()) qInfo("No PDFs in %s (see slides/create_dummy_presentation.py)", SLIDES_DIR);
+    }
+
+    QString outputPath;
+    if (parser.isSet(outputOption)) outputPath = QFileInfo(parser.value(outputOption)).absoluteFilePath();
+
+    // Settings and annotation sidecars of the driven window stay out of the user's files
+    QTemporaryDir workDir;
+    if (!workDir.isValid()) qFatal("Cannot create a temporary directory");
+    QDir::setCurrent(workDir.path());
+    // Cold measurements stay cold: the driven window keeps nothing on disk between runs
+    QSettings(".my_presenter_config.ini", QSettings::IniFormat).setValue("render/diskCacheMB", 0);
+
+    int stressPages = parser.value(stressOption).toInt();
+    if (stressPages > 0) {
+        QString stressDeck = workDir.filePath("stress.pdf");
+        qInfo("Generating %d-page stress deck...", stressPages);
+        if (writeStressDeck(stressDeck, stressPages)) decks.append(stressDeck);
+        else qWarning("Could not write the stress deck");
+    }
+
+    Benchmark benchmark(qMax(1, parser.value(sampleOption).toInt()));
+    QJsonArray results;
+    for (const QString &deck : decks) {
+        qInfo("Benchmarking %s", qPrintable(deck));
+        results.append(benchmark.runDeck(deck));
+    }
+
+    QJsonObject root;
+    root["qtVersion"] = QString(qVersion());
+    root["platform"] = QGuiApplication::platformName();
+    root["timestamp"] = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
+    root["decks"] = results;
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+    if (!outputPath.isEmpty()) {
+        QSaveFile out(outputPath);
+        if (!out.open(QIODevice::WriteOnly) || out.write(json) != json.size() || !out.commit()) {
+            qCritical("Cannot write %s", qPrintable(outputPath));
+            return 1;
+        }
+    } else {
+        fputs(json.constData(), stdout);
+    }
+    return 0;
+}
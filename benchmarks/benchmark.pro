@@ -0,0 +1,59 @@
+QT       += core gui widgets pdf pdfwidgets openglwidgets
+
+TARGET   = benchmark
+TEMPLATE = app
+
+# Enforce C++17
+CONFIG  += c++17 console
+CONFIG  -= app_bundle
+
+# Output directory for the binary (next to the app)
+DESTDIR  = $$PWD/../bin
+
+# Sample decks are picked up from here
+DEFINES += SLIDES_DIR=\\\"$$PWD/../slides\\\"
+
+# Benchmark driver plus the application code it measures (everything but main.cpp)
+SOURCES += benchmark.cpp \
+           ../src/batchrenderer.cpp \
+           ../src/mainwindow.cpp \
+           ../src/presentationdisplay.cpp \
+           ../src/screenselectorwidget.cpp \
+           ../src/flowlayout.cpp \
+           ../src/sliderenderer.cpp \
+           ../src/documentloader.cpp \
+           ../src/searchindex.cpp \
+           ../src/slidecache.cpp \
+           ../src/rasterdiskcache.cpp \
+           ../src/slidepackage.cpp \
+           ../src/slidesorter.cpp \
+           ../src/slideprefetcher.cpp \
+           ../src/annotationstore.cpp \
+           ../src/strokeprocessor.cpp \
+           ../src/renderprofiler.cpp \
+           ../src/audienceglsurface.cpp
+
+HEADERS += ../include/batchrenderer.h \
+           ../include/mainwindow.h \
+           ../include/presentationdisplay.h \
+           ../include/screenselectorwidget.h \
+           ../include/flowlayout.h \
+           ../include/sliderenderer.h \
+           ../include/documentloader.h \
+           ../include/searchindex.h \
+           ../include/slidecache.h \
+           ../include/rasterdiskcache.h \
+           ../include/slidepackage.h \
+           ../include/slidesorter.h \
+           ../include/slideprefetcher.h \
+           ../include/annotationstore.h \
+           ../include/strokeprocessor.h \
+           ../include/renderprofiler.h \
+           ../include/audienceglsurface.h
+
+# Include paths
+INCLUDEPATH += ../include
+
+# Intermediate build files
+OBJECTS_DIR = obj
+MOC_DIR     = obj
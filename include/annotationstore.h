@@ -0,0 +1,100 @@
+#ifndef ANNOTATIONSTORE_H
+#define ANNOTATIONSTORE_H
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QPolygonF>
+#include <QRgb>
+#include <QString>
+
+// Pen of an annotation stroke. The width is a fraction of the slide width so
+// strokes scale with the window.
+struct AnnotationPen
+{
+    QRgb color = 0;
+    float width = 0;
+    quint32 style = 0; // Qt::PenStyle
+
+    bool operator==(const AnnotationPen &other) const
+    {
+        return color == other.color && width == other.width && style == other.style;
+    }
+};
+
+// Per-page drawings in normalized slide coordinates (0..1 across the slide).
+//
+// Strokes are kept structure-of-arrays: one flat point buffer, the index of
+// each stroke's first point, and a palette index per stroke. The sidecar file
+// uses the same layout and is memory-mapped, so opening it reads nothing but
+// the stroke index (to validate it); a page is only copied out of the mapping
+// when edited.
+// Only used from the GUI thread.
+class AnnotationStore
+{
+public:
+    AnnotationStore();
+    ~AnnotationStore();
+
+    // "talk.pdf" -> "talk.pdf.annotations"
+    static QString sidecarPath(const QString &pdfPath);
+
+    // Maps an existing sidecar; a missing or unreadable one starts empty.
+    // Unsaved edits of the previous file are dropped, so save() first.
+    void open(const QString &filePath);
+    // Writes the sidecar if anything changed. Returns false on I/O errors.
+    bool save();
+    void close();
+    QString filePath() const { return path; }
+    bool isDirty() const { return dirty; }
+
+    int strokeCount(int page) const;
+    QPolygonF strokePoints(int page, int stroke) const;
+    AnnotationPen strokePen(int page, int stroke) const;
+
+    void addStroke(int page, const QPolygonF &stroke, const AnnotationPen &pen);
+    void clearPage(int page);
+
+private:
+    // An edited page, same layout as in the file
+    struct Page {
+        QList<quint32> firstPoint{0}; // strokeCount + 1 entries
+        QList<quint32> pens;          // Palette index per stroke
+        QList<float> points;          // x0, y0, x1, y1, ...
+    };
+    // A read-only view of one page, either into the mapping or into a Page
+    struct PageView {
+        const quint32 *firstPoint = nullptr;
+        const quint32 *pens = nullptr;
+        const float *points = nullptr;
+        int strokes = 0;
+        quint32 pointCount = 0; // Size of the buffer 'points' indexes into
+    };
+
+    PageView view(int page) const;
+    Page &editablePage(int page);
+    quint32 paletteIndex(const AnnotationPen &pen);
+    bool mapFile();
+    void unmap();
+
+    QString path;
+    QFile file;
+    uchar *map;
+
+    // Tables inside the mapping (null when nothing is mapped)
+    quint32 mappedPages;
+    quint32 mappedPalette;
+    quint32 mappedStrokes;
+    quint32 mappedPoints;
+    const quint32 *pageTable;   // First stroke and stroke count per page
+    const quint32 *paletteWords;
+    const quint32 *firstPoint;  // Into points; strokeCount + 1 entries
+    const quint32 *strokePens;
+    const float *points;
+
+    QList<AnnotationPen> palette;
+    QHash<int, Page> edited;
+    bool dirty;
+};
+
+#endif // ANNOTATIONSTORE_H
@@ -0,0 +1,28 @@
+#ifndef AUDIENCEGLSURFACE_H
+#define AUDIENCEGLSURFACE_H
+
+#include <QOpenGLWidget>
+#include <functional>
+
+// Hardware-composited drawing surface for the audience window. It covers its
+// parent and lets mouse events through; the parent supplies the scene.
+//
+// Painting goes through QPainter's OpenGL engine, which keeps a texture per
+// QImage (keyed by QImage::cacheKey()). An unchanged slide raster, zoom tile or
+// stroke layer is therefore uploaded once and then only sampled, so a frame
+// costs the same for a 1080p and an 8K slide. Works on software GL (llvmpipe).
+class AudienceGLSurface : public QOpenGLWidget
+{
+public:
+    using ScenePainter = std::function<void(QPainter &painter, const QRect &area)>;
+
+    AudienceGLSurface(const ScenePainter &paintScene, QWidget *parent);
+
+protected:
+    void paintGL() override;
+
+private:
+    ScenePainter paintScene;
+};
+
+#endif // AUDIENCEGLSURFACE_H
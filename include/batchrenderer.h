@@ -0,0 +1,56 @@
+#ifndef BATCHRENDERER_H
+#define BATCHRENDERER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QSize>
+#include <QString>
+
+// What to export in --render-out mode
+struct BatchRenderOptions
+{
+    enum class Split { None, Slide, Notes, Both };
+
+    QString sourcePath;
+    QString outputDir;
+    QString pages;           // "1-3,7,10-" (1-based); empty means all pages
+    QList<QSize> sizes;      // Each page is fitted into every box
+    Split split = Split::None;
+    QByteArray format = "png";
+    int quality = -1;        // Encoder quality, -1 for the format's default
+    int jobs = 0;            // Workers; 0 means one per core
+};
+
+// Exports slides to image files without any UI. Every worker opens its own
+// QPdfDocument and pulls pages from a shared counter, and each image is encoded
+// to disk as soon as it is rendered, so memory stays flat. QtPdf serializes
+// rasterization behind one lock, so extra workers overlap encoding and file
+// writes with it rather than rendering in parallel; the benchmark measures
+// how far that scales.
+class BatchRenderer
+{
+public:
+    explicit BatchRenderer(const BatchRenderOptions &options);
+
+    // Blocks until everything is written. Returns the number of images that
+    // failed, or -1 if nothing could be started (bad document, options or directory).
+    int run();
+
+    // "1-3,7,10-" -> zero-based page numbers, in order and without duplicates
+    static bool parsePages(const QString &spec, int pageCount, QList<int> *pages);
+    // "1920x1080"
+    static QSize parseSize(const QString &text);
+
+private:
+    struct Job {
+        int page;
+        QSize box;
+        BatchRenderOptions::Split half; // None, Slide or Notes
+    };
+
+    QString fileNameFor(const Job &job, int pageCount) const;
+
+    BatchRenderOptions options;
+};
+
+#endif // BATCHRENDERER_H
@@ -0,0 +1,45 @@
+#ifndef DOCUMENTLOADER_H
+#define DOCUMENTLOADER_H
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include "searchindex.h"
+
+class QPdfDocument;
+class QPdfBookmarkModel;
+class QThread;
+
+// Opens the GUI-side QPdfDocument and builds its bookmark tree on a background
+// thread, then hands both to the GUI thread. For large proceedings, building
+// the bookmark model alone can take longer than rendering the first slide, so
+// callers start this once the first slide is on screen. The full-text search
+// index follows on the same thread, one page at a time.
+class DocumentLoader : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DocumentLoader(QObject *parent = nullptr);
+    ~DocumentLoader();
+
+    // Supersedes any load still in flight; its result is discarded
+    void load(const QString &filePath);
+    // Discards whatever is in flight, so nothing of it arrives after this returns
+    void cancel();
+
+signals:
+    // Both objects live on the GUI thread, unparented; the receiver owns them.
+    // A file that failed to open still arrives, with an error status.
+    void loaded(QPdfDocument *document, QPdfBookmarkModel *bookmarks);
+    void indexProgress(int pagesDone, int pageCount);
+    // Text of every page, after loaded()
+    void indexed(const SearchIndex &index);
+
+private:
+    QThread *workerThread;
+    QObject *context; // Lives on workerThread; queued work runs there
+    std::atomic<quint64> generation; // Also read by the worker, to abandon superseded indexing
+};
+
+#endif // DOCUMENTLOADER_H
@@ -12,6 +12,13 @@
 #include "screenselectorwidget.h"
 #include <QShortcut>
 #include "presentationdisplay.h"
+#include "sliderenderer.h"
+#include "slideprefetcher.h"
+#include "annotationstore.h"
+#include "documentloader.h"
+#include "searchindex.h"
+#include "slidesorter.h"
+#include "slidepackage.h"
 #include <QCheckBox>
 #include <QSlider>
 #include <QColorDialog>
@@ -20,18 +27,36 @@
 #include <QScrollArea>
 #include <QComboBox>
 #include <QSpinBox>
+#include <QThreadPool>
 #include <QGroupBox>
+#include <QProgressBar>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QStackedWidget>
 
 #include <QTime>
+#include <QVBoxLayout>
+#include <functional>
 
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    // Without initialFile, a file dialog asks for the deck once the window is up
+    MainWindow(QWidget *parent = nullptr, const QString &initialFile = QString());
     ~MainWindow();
 
+    // Plays the audience window from a package made with --compile whenever the
+    // open deck is the one it was compiled from. False if it cannot be read.
+    bool openSlidePackage(const QString &path);
+
+signals:
+    // Console, notes, preview and audience all show final rasters for 'page'
+    void viewsSettled(int page);
+    // Every deferred panel is built and, if a deck was given, its first slide is up
+    void startupComplete();
+
 protected:
     void closeEvent(QCloseEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
@@ -40,6 +65,8 @@ protected:
 
 private slots:
     void onBookmarkActivated(const QModelIndex &index);
+    void onSlideRendered(quint64 ticket, const RenderRequest &request, const QImage &image);
+    void onAudienceQualityChanged(PresentationDisplay::SlideQuality quality);
     void updateTimers();
     void toggleSplitView();
     void resetLayout();
@@ -79,23 +106,102 @@ private slots:
     void activateDrawing();
     void updateDrawingSettings();
 
+    // Instrumentation
+    void toggleProfilerHud(); // F12
+    void exportTrace();       // Ctrl+E, Chrome trace JSON
+
+    void focusSearch();       // Ctrl+F
+    void toggleSlideSorter(); // O: grid of all slides
+
 private:
     void loadPdf(const QString &filePath);
     void setupUi();
+    // Deferred startup stages, one per event-loop turn after the first frame
+    void buildSearchPanel();
+    void buildChaptersPanel();
+    void buildMonitorPanel();
+    void buildControlCenter();
+    void runNextStartupStage();
+    void checkStartupComplete();
     void updateViews();
-    void detectScreens();
+    RenderRequest consoleRequestForPage(int page) const;
+    RenderRequest notesRequestForPage(int page) const;
+    RenderRequest previewRequestForPage(int page) const;
+    RenderRequest thumbnailRequestForPage(int page) const; // Search results
+    void showCurrentSlide(const QImage &image);
+    void showNotesPage(const QImage &image);
+    void showNextSlide(const QImage &image);
+    void placeAudienceWindow();
     void syncTocWithPage(int page);
+    void watchBookmarks();
+    void rebuildTocIndex();
+    void jumpToPage(int page);
+    void closeSlideSorter();
     void setupShortcuts();
     void updateScreenControls();
     void loadSettings();
+    void loadEarlySettings(); // Geometry and render settings needed before the first frame
     void saveSettings();
+    void updateProfilerHud();
+    void checkViewsSettled();
+    // Loading: page geometry and slide 0 first, bookmarks once that slide is up
+    void onDocumentReady();
+    void onLoadProgress(int pagesDone, int pageCount);
+    // Plays from the package if the deck's content key is the one it was compiled from
+    void onPackageKey(quint64 check, const QByteArray &contentKey);
+    void onDocumentLoaded(QPdfDocument *document, QPdfBookmarkModel *bookmarks);
+    void showLoadStatus(const QString &message, int value = 0, int maximum = 0);
+    // Full-text search: the index is built in the background after the bookmarks
+    void onIndexProgress(int pagesDone, int pageCount);
+    void onSearchIndexed(const SearchIndex &index);
+    void runSearch();
+    void showSearchThumbnail(int page, const QImage &image);
+    void updateSearchHighlights();
     
     // Window Mode Slots
     void toggleAspectRatioLock(bool enabled);
 
     // Data
-    QPdfDocument *pdf;
+    QPdfDocument *pdf;                // GUI-side copy for bookmarks; replaced by each load
     QPdfBookmarkModel *bookmarkModel;
+    // Chapter lookup by page: one entry per distinct bookmark page, sorted, so a
+    // page change is a binary search. Rebuilt lazily when the model changes.
+    struct TocEntry {
+        int page;
+        QPersistentModelIndex index;
+    };
+    QList<TocEntry> tocEntries;
+    bool tocStale;
+    DocumentLoader *documentLoader;
+    QString loadingFile;              // Set until the first slide of a new deck is on screen
+    qint64 loadStart;
+    QProgressBar *loadProgressBar;
+    SearchIndex searchIndex;          // Empty until the loader has read every page
+    QHash<quint64, int> searchTickets; // Thumbnail render ticket -> page
+    SlidePackage slidePackage;        // Closed unless --package was given
+    quint64 packageCheck;             // Bumped per deck, so a key hashed for an older one is dropped
+    bool packageKeyPending;           // The deck is rendered live until its key settles the match
+    QThreadPool packageHashPool;      // Hashes the deck when the renderer has no disk cache to do it
+
+    // Staged startup
+    struct StartupStage {
+        const char *name; // Profiler event name, so a string literal
+        std::function<void()> build;
+    };
+    QList<StartupStage> startupStages;
+    bool awaitingFirstSlide;
+    bool startupDone;
+    QVBoxLayout *leftColumn;  // Chapters and monitor manager, filled by startup stages
+    QVBoxLayout *rightColumn; // Next slide, then the control center
+    SlideRenderer *renderer;
+    SlidePrefetcher *prefetcher;
+    AnnotationStore *annotations; // Audience drawings, saved next to the PDF
+    quint64 currentTicket; // Console current slide
+    quint64 notesTicket;   // Notes half of the current page in split view
+    quint64 nextTicket;    // Next slide preview
+    bool settling;         // updateViews() issued work that has not all landed yet
+    bool audienceReady;
+    qint64 settleStart;
     int currentPage;
     bool showLaser;
     bool useSplitView;
@@ -119,10 +225,16 @@ private:
     // QDockWidget *tocDock; ...
 
     QLabel *currentSlideView;
+    QLabel *audienceQualityLabel;
+    QLabel *profilerHud;
     QLabel *nextSlideView;
     QTextEdit *notesView;
     QLabel *notesImageView;
     QTreeView *tocView;
+    QStackedWidget *consoleStack; // Console layout, or the slide sorter in its place
+    SlideSorter *slideSorter;     // Built the first time it is opened
+    QLineEdit *searchBox;
+    QListWidget *searchResults;
     
     QLabel *timeLabel;
     QLabel *elapsedLabel;
@@ -148,11 +260,15 @@ private:
     QComboBox *drawingColorCombo;
     QComboBox *drawingStyleCombo;
     QSpinBox *drawingThicknessSpin;
+    QCheckBox *drawingSmoothCheck;
     
     // Window Controls
     QCheckBox *consoleFullscreenCheck;
     QCheckBox *audienceFullscreenCheck;
     QCheckBox *aspectRatioCheck;
+    QCheckBox *tiledRenderingCheck;
+    QCheckBox *gpuCompositingCheck;
+    QComboBox *transitionCombo;
     QPushButton *closeButton;
 
     // QByteArray defaultState; // Removed for fixed layout
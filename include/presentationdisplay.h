@@ -6,21 +6,50 @@
 #include <QPainter>
 #include <QMouseEvent>
 #include <QPoint>
-#include <QPdfDocument>
+#include <QHash>
+#include <QRegion>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "sliderenderer.h"
+#include "annotationstore.h"
+#include "strokeprocessor.h"
+
+class AudienceGLSurface;
+class SlidePackage;
 
 class PresentationDisplay : public QWidget
 {
     Q_OBJECT
 
 public:
+    // What the audience currently sees for the current page
+    enum SlideQuality { NoSlide, Placeholder, FullQuality };
+    Q_ENUM(SlideQuality)
+    enum TransitionStyle { NoTransition, Crossfade, Push, Cover };
+    Q_ENUM(TransitionStyle)
+
     explicit PresentationDisplay(QWidget *parent = nullptr);
     
-    void setDocument(QPdfDocument *doc);
+    void setRenderer(SlideRenderer *r);
     void setPage(int page);
     void setSplitMode(bool split);
     
-    // Explicit update trigger if needed, though setters usually trigger repaint
+    // Marks the slide raster stale. Any number of calls within one event-loop
+    // turn (page, split mode, resize, DPR) collapse into a single render.
     void refreshSlide();
+
+    // How well refreshSlide() coalesces; shown in the F12 HUD and the benchmark
+    struct RenderStats {
+        quint64 invalidations = 0; // refreshSlide() calls
+        quint64 renders = 0;       // Render passes actually issued
+    };
+    RenderStats renderStats() const { return stats; }
+
+    // The render this window would issue for 'page' at its current size (used for prefetching).
+    // resolutionScale < 1 yields a cheaper raster of the same region.
+    RenderRequest requestForPage(int page, qreal resolutionScale = 1.0) const;
+    SlideQuality slideQuality() const { return quality; }
+    bool isRefreshPending() const { return refreshQueued; }
     
     void enableLaserPointer(bool active);
     void setLaserSettings(int diameter, int opacity); // Configurable size/opacity
@@ -30,12 +59,51 @@ public:
     void setZoomSettings(float factor, int diameter);
     void setAspectRatioLock(bool locked);
 
+    // Tiled mode renders the slide as fixed-size tiles in parallel (video walls, 8K)
+    void setTiledRendering(bool enabled);
+    bool tiledRendering() const { return tiled; }
+
+    // Playback: slides come pre-rendered from 'package' and the renderer is never
+    // asked for them. The package must stay open while set; null goes back to live rendering.
+    void setPackage(const SlidePackage *package);
+    bool playsFromPackage() const { return package != nullptr; }
+
+    // Composite through OpenGL: slide rasters are uploaded once as textures, so
+    // lens, laser and stroke frames no longer blit the full slide on the CPU
+    void setHardwareCompositing(bool enabled);
+    bool hardwareCompositing() const { return glSurface != nullptr; }
+
+    // Page changes animate between the outgoing and incoming cached rasters. If
+    // the incoming page is not cached yet the change is an instant cut: frames
+    // are never held back waiting for the PDF renderer.
+    void setTransition(TransitionStyle style, int durationMs = 350);
+    TransitionStyle transitionStyle() const { return transition; }
+    int transitionDuration() const { return transitionMs; }
+    bool isTransitioning() const { return transitioning; }
+
+    struct TransitionStats {
+        int frames = 0;
+        int droppedFrames = 0;     // Display refreshes that passed without a new frame
+        qreal frameBudgetMs = 0;   // One refresh interval
+        qreal worstFrameMs = 0;
+    };
+    // Frame pacing of the most recent (or running) transition
+    TransitionStats transitionStats() const { return lastTransition; }
+
+    // Search hits to outline while 'page' is shown, in normalized page coordinates
+    // (0..1 across the whole page, notes half included). An empty list clears them.
+    void setHighlights(int page, const QList<QRectF> &pageRects);
+
     // Drawing
     void enableDrawing(bool active);
     void setDrawingColor(const QColor &color);
     void setDrawingThickness(int thickness);
     void setDrawingStyle(Qt::PenStyle style);
+    // Round off committed strokes with Catmull-Rom splines
+    void setDrawingSmoothing(bool enabled);
     void clearDrawings();
+    // Drawings are kept per page in 'store' and come back when the page is shown again
+    void setAnnotationStore(AnnotationStore *store);
     
 protected:
     void paintEvent(QPaintEvent *event) override;
@@ -43,16 +111,66 @@ protected:
     void mouseMoveEvent(QMouseEvent *event) override;
     void mouseReleaseEvent(QMouseEvent *event) override;
     void resizeEvent(QResizeEvent *event) override;
+    bool event(QEvent *event) override;
+
+signals:
+    void slideQualityChanged(PresentationDisplay::SlideQuality quality);
+    // The full-quality raster of 'page' is on screen
+    void slideReady(int page);
+
+private slots:
+    void onImageReady(quint64 ticket, const RenderRequest &request, const QImage &image);
 
 private:
+    void flushRefresh();
     void renderCurrentSlide();
+    void renderTiles(const RenderRequest &request);
+    void cancelPendingRenders();
+
+    // Zoom lens helpers
+    QRect slideTargetRect() const;
+    QRect slideRegion() const; // Area of the page raster cachedSlide shows
+    void requestZoomTiles();
+    void clearZoomTiles();
+    void drawZoomTiles(QPainter &painter, const QRect &slideRect, const QPoint &center);
+    QRect lensBounds(const QPoint &center) const;
+
+    // Partial repaints: dirty areas are merged and flushed at most once per display frame
+    void scheduleRepaint(const QRect &area);
+    void flushRepaint();
+    void updateSurface();
+    void updateSurface(const QRegion &area);
+    void paintScene(QPainter &painter, const QRect &dirty);
+    qreal frameIntervalMs() const;
+
+    // Transitions
+    void startTransition();
+    void finishTransition();
+    void paintTransition(QPainter &painter);
+    void recordTransitionFrame();
+    void paintHighlights(QPainter &painter, const QRect &slideRect, const QRect &dirty);
+    void setSlideQuality(SlideQuality q);
     QCursor createLaserCursor();
     QCursor createPenCursor(); // Helper for pencil cursor
 
-    QPdfDocument *pdf;
+    SlideRenderer *renderer;
     int currentPage;
     bool splitView;
     QImage cachedSlide;
+    quint64 pendingTicket;     // Latest render we are waiting for; older results are dropped
+    quint64 placeholderTicket; // Quick low-resolution render shown until pendingTicket lands
+    SlideQuality quality;
+    int finalSlidePage;        // Page cachedSlide is the final raster of, or -1
+    bool previousPageShown;    // cachedSlide is still the page turned away from
+
+    // Tiled rendering: cachedSlide is the frame tiles are composited into
+    bool tiled;
+    QHash<quint64, QRect> pendingTiles; // Ticket -> tile rectangle in frame pixels
+    bool refreshQueued;
+    RenderStats stats;
+    AudienceGLSurface *glSurface; // Null when painting in software
+    const SlidePackage *package;  // Null when rendering live
+    QSize warnedPackageSize;      // Window size the package mismatch was last reported for
     
     // Laser
     QCursor laserCursor;
@@ -66,20 +184,58 @@ private:
     float zoomFactor;
     int zoomDiameter;
     QPoint mousePos;
+    // Sharp lens content: tiles of the page rendered at zoomFactor x slide resolution
+    RenderRequest slideRequest;                // Full-quality request behind cachedSlide
+    QSize zoomPageSize;                        // Page raster size the zoom tiles were cut from
+    QHash<quint64, QImage> zoomTiles;          // (row << 32 | column) -> raster
+    QHash<quint64, quint64> pendingZoomTiles;  // Ticket -> tile key
     
     // Drawing
     struct Stroke {
         QPolygonF points;
         QPen pen;
+        QRectF bounds; // Including pen width
     };
-    QList<Stroke> strokes;
-    QPolygonF currentStroke;
+    // Committed strokes are baked into strokeLayer once; only the live stroke is vector-drawn per frame
+    void bakeStroke(const Stroke &stroke); // Onto the layer as it is: call ensureStrokeLayer() first
+    void ensureStrokeLayer();
+    void clearStrokeLayer();
+    // Strokes are stored relative to the slide area so they follow resizes
+    QRect annotationRect() const;
+    void loadPageStrokes();
+    AnnotationStore *annotations;
+    QList<Stroke> strokes; // Current page, in widget coordinates
+    QImage strokeLayer; // Rasterized committed strokes at window size x DPR
+    StrokeProcessor strokeInput; // Stroke being drawn, decimated as it arrives
     bool drawingActive;
     QColor drawColor;
     int drawThickness;
     Qt::PenStyle drawStyle;
     bool isDrawing; // Track if mouse is down
 
+    // Transitions: transitionFrom is the outgoing raster, cachedSlide the incoming one
+    TransitionStyle transition;
+    int transitionMs;
+    bool transitionPending;  // Page changed; animate if the new raster is ready at flush time
+    bool transitioning;
+    bool transitionFrameDue; // Next paint is a paced frame (timer, buffer swap or the first one)
+    QImage transitionFrom;
+    QRect transitionFromRect;
+    int transitionDirection; // 1 forward, -1 backward
+    QElapsedTimer transitionClock;
+    qint64 lastFrameNs;
+    QTimer *frameTimer;      // Paces software frames to the display refresh
+    TransitionStats lastTransition;
+
+    // Search highlights
+    int highlightPage;
+    QList<QRectF> highlights;
+
+    // Repaint coalescing
+    QRegion dirtyRegion;
+    QTimer *repaintTimer;
+    QElapsedTimer sinceLastFlush;
+
     // Window Mode
     bool lockedAspectRatio;
     bool isResizing;
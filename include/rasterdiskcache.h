@@ -0,0 +1,69 @@
+#ifndef RASTERDISKCACHE_H
+#define RASTERDISKCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QSizeF>
+#include <QString>
+
+struct RenderRequest;
+
+// Rendered rasters kept on disk between runs, so a rehearsed deck reopens
+// without rasterizing anything. Layout under the cache directory:
+//   files/<path hash>          size, mtime and content key of a PDF seen before
+//   <content key>/pages        page geometry of that document
+//   <content key>/<request>.mpr  one zlib-compressed raster per render request
+// Entries are keyed by document content, not path, so a copied or re-downloaded
+// deck still hits. Files are memory-mapped when read; the least recently used
+// are deleted once the directory outgrows its budget.
+// Thread-safe: render workers read and write it concurrently.
+class RasterDiskCache
+{
+public:
+    RasterDiskCache(const QString &directory, qint64 budgetBytes);
+
+    QString directory() const { return root; }
+
+    // Content key of 'filePath'. Cheap when size and mtime match a previous
+    // visit; otherwise the file is hashed. Empty if it cannot be read.
+    QByteArray documentKey(const QString &filePath);
+    // Only the cheap half: the recorded key, or empty if the file is new or touched
+    QByteArray knownDocumentKey(const QString &filePath);
+
+    bool loadPageSizes(const QByteArray &document, QList<QSizeF> *sizes);
+    void storePageSizes(const QByteArray &document, const QList<QSizeF> &sizes);
+
+    // Null on miss
+    QImage load(const QByteArray &document, const RenderRequest &request);
+    void store(const QByteArray &document, const RenderRequest &request, const QImage &image);
+
+    static QString defaultDirectory();
+    // Hex hash of the file's bytes, always computed; empty if it cannot be read
+    static QByteArray contentKey(const QString &filePath);
+
+private:
+    struct Entry {
+        qint64 size;
+        qint64 lastUsed; // ms since epoch
+    };
+
+    QString recordPath(const QString &filePath) const;
+    static QByteArray fileStamp(const QString &filePath);
+    QString entryPath(const QByteArray &document, const RenderRequest &request) const;
+    void ensureScanned();                  // Called with mutex held
+    void noteUse(const QString &path, qint64 size); // Called with mutex held
+    void evict();                          // Called with mutex held
+
+    QString root;
+    qint64 budget;
+
+    QMutex mutex;
+    bool scanned;
+    QHash<QString, Entry> entries; // Raster files by path
+    qint64 usedBytes;
+};
+
+#endif // RASTERDISKCACHE_H
@@ -0,0 +1,54 @@
+#ifndef RENDERPROFILER_H
+#define RENDERPROFILER_H
+
+#include <QList>
+#include <QString>
+
+// Process-wide timing recorder for the render pipeline. Any thread may record;
+// events go into a fixed-size lock-free ring buffer (the oldest are overwritten),
+// so recording is always on and costs a few atomic stores.
+class RenderProfiler
+{
+public:
+    struct Event {
+        const char *name = nullptr; // Must be a string literal
+        qint64 startNs = 0;         // Since process start
+        qint64 durationNs = 0;
+        int thread = 0;             // Small per-thread number, see threadName()
+    };
+    struct Percentiles {
+        int samples = 0;
+        double p50Ms = 0;
+        double p99Ms = 0;
+    };
+
+    static qint64 now();
+    static void record(const char *name, qint64 startNs, qint64 durationNs);
+
+    // Buffered events, oldest first
+    static QList<Event> events();
+    static Percentiles percentiles(const char *name);
+    static QString threadName(int thread);
+
+    // Input-to-audience latency: started by a navigation action, finished by the
+    // first full-quality paint of that page. GUI thread only.
+    static void beginPageTurn(int page);
+    static void endPageTurn(int page);
+
+    // Chrome trace event format; open in chrome://tracing or ui.perfetto.dev
+    static bool exportChromeTrace(const QString &filePath);
+};
+
+// Records the lifetime of the scope as one event
+class ProfileScope
+{
+public:
+    explicit ProfileScope(const char *name) : name(name), start(RenderProfiler::now()) {}
+    ~ProfileScope() { RenderProfiler::record(name, start, RenderProfiler::now() - start); }
+
+private:
+    const char *name;
+    qint64 start;
+};
+
+#endif // RENDERPROFILER_H
@@ -0,0 +1,77 @@
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QRectF>
+#include <QString>
+#include <QStringList>
+
+// Inverted index over the text of every page, for search-as-you-type in the
+// console. Pages are tokenized once when the index is built (letters and
+// digits, lowercased); a query is then answered from the index alone:
+//  - every word of the query must occur on a page; the last word also matches
+//    as a prefix, so results follow each keystroke;
+//  - pages are ranked by tf-idf, and pages containing the query as a phrase
+//    rank higher.
+// Word boxes are measured while indexing, off the GUI thread, so hits are
+// outlined on the page without asking PDFium again.
+class SearchIndex
+{
+public:
+    struct Hit {
+        int page;
+        double score;
+        QString snippet; // Text around the first match
+    };
+
+    // Pages may be added in any order, but each only once. 'wordBoxes' holds a
+    // box per word of tokenize(text), in page coordinates normalized to 0..1;
+    // words without one are found but not outlined.
+    void addPage(int page, const QString &text, const QList<QRectF> &wordBoxes = QList<QRectF>());
+    // Sorts the vocabulary for prefix lookups; call once all pages are added
+    void finalize();
+    void clear();
+
+    bool isEmpty() const { return pages.isEmpty(); }
+    int pageCount() const { return pages.size(); }
+
+    // Best pages first, at most 'limit'
+    QList<Hit> search(const QString &query, int limit = 20) const;
+    // Normalized box of every word on 'page' that matches a word of 'query'
+    QList<QRectF> matchesOnPage(int page, const QString &query) const;
+
+    // Lowercased words of 'text'; 'spans' receives their (offset, length)
+    static QStringList tokenize(const QString &text, QList<QPair<int, int>> *spans = nullptr);
+
+private:
+    struct Word {
+        int term;
+        int offset;
+        int length;
+        QRectF box; // Normalized, empty if unknown
+    };
+    struct Posting {
+        int page;
+        int count;
+    };
+    struct Page {
+        QString text;
+        QList<Word> words; // In reading order
+    };
+
+    // Term ids matching 'word' exactly, or every term starting with it
+    QList<int> matchingTerms(const QString &word, bool prefix) const;
+    // Indexes into page.words of the words matching 'words'
+    QList<int> matchingWords(const Page &page, const QStringList &words, bool lastIsPrefix, bool firstOnly) const;
+    bool containsPhrase(const Page &page, const QStringList &words, bool lastIsPrefix) const;
+
+    QHash<int, Page> pages;
+    QHash<QString, int> termIds;
+    QStringList terms;                 // By term id
+    QList<QList<Posting>> postings;    // By term id, one entry per page
+    QList<int> sortedTerms;            // Term ids in lexical order, for prefix ranges
+};
+
+#endif // SEARCHINDEX_H
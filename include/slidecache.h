@@ -0,0 +1,75 @@
+#ifndef SLIDECACHE_H
+#define SLIDECACHE_H
+
+#include <QCache>
+#include <QHash>
+#include <QHashFunctions>
+#include <QImage>
+#include <QRect>
+#include <QSize>
+
+struct SlideCacheKey
+{
+    quint64 document = 0; // Load generation of the document
+    int page = -1;
+    QSize pageSize;
+    QRect clip;
+
+    bool operator==(const SlideCacheKey &other) const
+    {
+        return document == other.document && page == other.page
+            && pageSize == other.pageSize && clip == other.clip;
+    }
+};
+
+inline size_t qHash(const SlideCacheKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.document, key.page, key.pageSize.width(), key.pageSize.height(),
+                      key.clip.x(), key.clip.y(), key.clip.width(), key.clip.height());
+}
+
+// Bounded LRU of rendered slide rasters. The budget is in bytes of pixel data.
+// Only used from the GUI thread.
+class SlideCache
+{
+public:
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 evictions = 0;
+        int entries = 0;
+        qint64 usedBytes = 0;
+        qint64 budgetBytes = 0;
+    };
+
+    explicit SlideCache(qint64 budgetBytes = 512LL * 1024 * 1024);
+
+    void setBudget(qint64 bytes);
+    qint64 budget() const;
+
+    // Returns a null image on miss. Hits become most recently used.
+    QImage find(const SlideCacheKey &key);
+    bool contains(const SlideCacheKey &key) const;
+    // Largest cached raster of the same page region at any resolution, meant for
+    // placeholders. Not counted as a hit or miss, and only the raster returned
+    // becomes most recently used.
+    QImage findAnyResolution(const SlideCacheKey &key) const;
+    void insert(const SlideCacheKey &key, const QImage &image);
+    void clear();
+
+    Stats stats() const;
+
+private:
+    static qsizetype costOf(const QImage &image);
+
+    // Cost is tracked in KiB so large budgets stay well inside qsizetype on any platform
+    QCache<SlideCacheKey, QImage> images;
+    // Size of every raster in 'images' (and of some already evicted), so lookups
+    // across resolutions can scan without touching the LRU order
+    QHash<SlideCacheKey, QSize> dimensions;
+    quint64 hits;
+    quint64 misses;
+    quint64 evictions;
+};
+
+#endif // SLIDECACHE_H
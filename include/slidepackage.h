@@ -0,0 +1,55 @@
+#ifndef SLIDEPACKAGE_H
+#define SLIDEPACKAGE_H
+
+#include <QFile>
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+struct RenderRequest;
+
+// A whole deck rendered ahead of time at the projector's resolution. Layout:
+//   header                      page count, box, source size and hash
+//   index                       one entry per page and view, in page order
+//   frames                      raw pixels, each starting on a 4 KiB boundary
+// The file is memory-mapped as a whole and frames are handed out as images
+// over the mapping, so showing a slide copies nothing and never touches PDFium:
+// a page turn is a read through the OS page cache.
+class SlidePackage
+{
+public:
+    // What the audience window shows of a page
+    enum View { FullPage, SlideHalf, ViewCount };
+
+    SlidePackage();
+    ~SlidePackage();
+
+    // Renders every page of 'sourcePath' fitted into 'box' (physical pixels),
+    // whole and as the slide half of a notes page, and writes the package to
+    // 'packagePath'. Blocks; returns the number of frames that failed, or -1
+    // if nothing could be started. Nothing is written unless all frames succeed.
+    static int build(const QString &sourcePath, const QString &packagePath, const QSize &box, int jobs = 0);
+
+    bool open(const QString &path);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    int pageCount() const;
+    QSize box() const;
+    // Whether a file of this size and page count could be the package's source.
+    // Cheap; whether it is must be settled by comparing contentKey().
+    bool couldMatch(const QString &sourcePath, int pageCount) const;
+    // RasterDiskCache::contentKey() of the source it was compiled from
+    QByteArray contentKey() const;
+
+    // Zero-copy image of the frame, valid while the package stays open; null if
+    // missing. 'request' receives the render it stands for (page size and clip).
+    QImage frame(int page, View view, qreal devicePixelRatio = 1.0, RenderRequest *request = nullptr) const;
+
+private:
+    QFile file;
+    uchar *data;
+    qint64 size;
+};
+
+#endif // SLIDEPACKAGE_H
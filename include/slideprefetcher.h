@@ -0,0 +1,45 @@
+#ifndef SLIDEPREFETCHER_H
+#define SLIDEPREFETCHER_H
+
+#include <QHash>
+#include <QList>
+#include <functional>
+#include "sliderenderer.h"
+
+// Warms the render cache around the current page while the presenter talks.
+// Each target (audience window, console view, ...) describes how it would render
+// a given page, so prefetched rasters match what the views ask for exactly.
+class SlidePrefetcher
+{
+public:
+    using RequestBuilder = std::function<RenderRequest(int page)>;
+
+    explicit SlidePrefetcher(SlideRenderer *renderer);
+
+    void addTarget(const RequestBuilder &builder);
+    void setWindow(int ahead, int behind);
+    int pagesAhead() const { return ahead; }
+    int pagesBehind() const { return behind; }
+
+    // A TOC jump: remembers where the presenter came from and where they like to go
+    void noteJump(int fromPage, int toPage);
+    // Schedules background renders around 'page'; drops the previous schedule.
+    void schedule(int page);
+    void reset();
+
+private:
+    QList<int> candidatePages(int page) const;
+
+    SlideRenderer *renderer;
+    QList<RequestBuilder> targets;
+    QList<quint64> tickets;
+    int ahead;
+    int behind;
+
+    int lastPage;
+    bool movingBackward;
+    int returnPage;              // Origin of the most recent TOC jump
+    QHash<int, int> jumpTargets; // TOC destination -> times visited
+};
+
+#endif // SLIDEPREFETCHER_H
@@ -0,0 +1,151 @@
+#ifndef SLIDERENDERER_H
+#define SLIDERENDERER_H
+
+#include <QObject>
+#include <QImage>
+#include <QList>
+#include <QPair>
+#include <QRect>
+#include <QSize>
+#include <QSizeF>
+#include <QString>
+#include <QThreadPool>
+#include <memory>
+#include "slidecache.h"
+
+class QPdfDocument;
+class QThread;
+class RenderWorker;
+class RasterDiskCache;
+
+// One rasterization job: the page is scaled to pageSize (physical pixels) and
+// the clip rectangle of that raster is returned. A null clip means the whole page.
+struct RenderRequest
+{
+    int page = -1;
+    QSize pageSize;
+    QRect clip;
+    qreal devicePixelRatio = 1.0;
+
+    bool isValid() const { return page >= 0 && !pageSize.isEmpty(); }
+    QSize outputSize() const { return clip.isNull() ? pageSize : clip.size(); }
+
+    bool operator==(const RenderRequest &other) const
+    {
+        return page == other.page && pageSize == other.pageSize && clip == other.clip
+            && qFuzzyCompare(devicePixelRatio, other.devicePixelRatio);
+    }
+    bool operator!=(const RenderRequest &other) const { return !(*this == other); }
+
+    // Fits 'crop' (normalized page coordinates) of a page into 'target' physical
+    // pixels, keeping the aspect ratio. Split view uses crop (0, 0, 0.5, 1).
+    static RenderRequest fitted(int page, const QSizeF &pagePointSize, const QSize &target,
+                                const QRectF &crop = QRectF(0, 0, 1, 1), qreal dpr = 1.0);
+};
+
+// Renders PDF pages on background threads. Every worker owns its own
+// QPdfDocument loaded from the same file, so the GUI thread never waits for
+// PDFium. Results come back on the GUI thread through imageReady().
+class SlideRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit SlideRenderer(QObject *parent = nullptr, int workerCount = 0);
+    ~SlideRenderer();
+
+    // Renders 'request' from 'document' on the calling thread. Null on failure.
+    static QImage rasterize(QPdfDocument *document, const RenderRequest &request);
+
+    // Opens 'filePath' on the first worker, which also reads the page geometry,
+    // so page 0 renders on an already open document and the GUI thread never
+    // waits for PDFium. Ends in documentReady() or loadFailed().
+    void openDocument(const QString &filePath);
+
+    bool isReady() const { return !pageSizes.isEmpty(); }
+    int pageCount() const { return pageSizes.size(); }
+    QSizeF pagePointSize(int page) const;
+
+    // Rendered images are kept in a memory-bounded LRU shared by all views.
+    // cachedImage() returns a null image on miss; callers then requestRender().
+    QImage cachedImage(const RenderRequest &request);
+    // Best cached raster of the same page region at another resolution, or null
+    QImage cachedPlaceholder(const RenderRequest &request) const;
+    void setCacheBudget(qint64 bytes);
+    SlideCache::Stats cacheStats() const;
+    // Also keeps rasters on disk, in 'directory', across runs: a deck opened
+    // before gets its geometry and rasters from there without loading PDFium.
+    // An empty directory turns it off. Takes effect with the next openDocument().
+    void setDiskCache(const QString &directory, qint64 budgetBytes);
+    // Content key of the open document in the disk cache. Empty until a newly seen
+    // deck has been hashed, which runs alongside the first renders; contentKeyReady()
+    // then follows. Never set without a disk cache.
+    QByteArray contentKey() const { return documentKey; }
+    bool hasDiskCache() const { return diskCache != nullptr; }
+
+    // Grows the worker pool (never shrinks it). Tiled rendering uses one per core.
+    void ensureWorkerCount(int count);
+    int workerCount() const { return workers.size(); }
+
+    // Interactive jobs always run before prefetch jobs, and prefetching never
+    // occupies the last idle worker.
+    enum class Priority { Interactive, Prefetch };
+
+    // Queues a job and returns its ticket. Identical jobs are rendered once.
+    // Every ticket gets one imageReady(), with a null image if rendering failed.
+    // Returns 0 for invalid requests, with no document open, and when
+    // prefetching something already cached.
+    quint64 requestRender(const RenderRequest &request, Priority priority = Priority::Interactive);
+    // Drops a ticket. Jobs nobody is waiting for anymore are never started.
+    void cancel(quint64 ticket);
+
+signals:
+    void documentReady();
+    void loadFailed();
+    // Page geometry pass of openDocument()
+    void loadProgress(int pagesDone, int pageCount);
+    // A newly seen deck finished hashing; known decks have their key by documentReady()
+    void contentKeyReady(const QByteArray &contentKey);
+    void imageReady(quint64 ticket, const RenderRequest &request, const QImage &image);
+
+private:
+    struct Job {
+        RenderRequest request;
+        QList<quint64> tickets;
+        Priority priority = Priority::Interactive;
+    };
+    struct WorkerSlot {
+        QThread *thread = nullptr;
+        RenderWorker *worker = nullptr;
+        bool busy = false;
+        Job job;
+        quint64 generation = 0; // Of the document the running job renders
+    };
+
+    void addWorker();
+    void resetDocument();
+    void onDocumentOpened(quint64 openGeneration, const QList<QSizeF> &sizes, const QByteArray &contentKey);
+    void onDocumentKey(quint64 openGeneration, const QByteArray &contentKey);
+    void storePageSizes();
+    SlideCacheKey cacheKey(const RenderRequest &request) const;
+    void enqueue(const Job &job);
+    void dispatch();
+    void startJob(int slotIndex, const Job &job);
+    void finishJob(int slotIndex, quint64 jobGeneration, const QImage &image);
+
+    QString sourcePath;
+    QList<QSizeF> pageSizes;
+    quint64 generation;
+    quint64 nextTicket;
+
+    SlideCache cache;
+    std::shared_ptr<RasterDiskCache> diskCache; // Jobs in flight hold on to it
+    QByteArray documentKey;                     // Content key of the open document in diskCache; empty until hashed
+    bool pageSizesStored;                       // pageSizes are in diskCache under documentKey
+    QThreadPool hashPool;                       // Content hashing of newly seen decks
+    QList<QPair<RenderRequest, QImage>> unkeyedRasters; // Rendered before documentKey was known
+    QList<Job> pending;
+    QList<WorkerSlot> workers;
+};
+
+#endif // SLIDERENDERER_H
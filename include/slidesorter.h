@@ -0,0 +1,80 @@
+#ifndef SLIDESORTER_H
+#define SLIDESORTER_H
+
+#include <QAbstractListModel>
+#include <QCache>
+#include <QHash>
+#include <QListView>
+#include <QPixmap>
+#include "sliderenderer.h"
+
+// Every page of the deck as a thumbnail, rendered on demand. The view only asks
+// for the decoration of rows it paints, so only visible pages are rendered; the
+// rest stay a placeholder until scrolled into view.
+class SlideThumbnailModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit SlideThumbnailModel(SlideRenderer *renderer, QObject *parent = nullptr);
+
+    // Box the thumbnails are fitted into, in device-independent pixels
+    void setThumbnailSize(const QSize &size, qreal devicePixelRatio);
+    // Split view shows the slide half of each page
+    void setSplitMode(bool split);
+    // Renders still queued for rows outside [first, last] are cancelled
+    void setVisibleRows(int first, int last);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+private:
+    // Follows the renderer's document; drops thumbnails and pending renders
+    void reset();
+    void cancelPending();
+    RenderRequest requestForPage(int page) const;
+    void onImageReady(quint64 ticket, const RenderRequest &request, const QImage &image);
+
+    SlideRenderer *renderer;
+    int rows;
+    QSize size;
+    qreal devicePixelRatio;
+    bool splitView;
+    QPixmap placeholder;
+
+    // Filled lazily from data(), hence mutable
+    mutable QCache<int, QPixmap> thumbnails; // Page -> pixmap, cost in KiB
+    mutable QHash<quint64, int> pending;     // Ticket -> page
+    mutable QHash<int, quint64> pendingPages;
+};
+
+// Console overview: a grid of every slide. Built on QListView so only the
+// visible cells are laid out and painted, however long the deck.
+class SlideSorter : public QListView
+{
+    Q_OBJECT
+
+public:
+    explicit SlideSorter(SlideRenderer *renderer, QWidget *parent = nullptr);
+
+    void setSplitMode(bool split);
+    // Selects 'page' and scrolls it into the middle
+    void showPage(int page);
+
+signals:
+    void pageActivated(int page);
+    void closeRequested(); // Escape
+
+protected:
+    bool event(QEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    void updateVisibleRows();
+
+    SlideThumbnailModel *thumbnails;
+};
+
+#endif // SLIDESORTER_H
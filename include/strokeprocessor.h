@@ -0,0 +1,55 @@
+#ifndef STROKEPROCESSOR_H
+#define STROKEPROCESSOR_H
+
+#include <QPolygonF>
+#include <QPointF>
+
+// Turns raw pointer input into a lean polyline. High polling-rate mice and
+// tablets report far more positions than a stroke needs, so:
+//  - while drawing, points closer than minDistance to the last kept point are
+//    dropped, and points that merely continue a straight run move its end
+//    instead of adding a vertex, as long as every vertex the run absorbed
+//    stays within simplifyTolerance of it;
+//  - on commit, Douglas-Peucker removes vertices within simplifyTolerance of
+//    the line, and optional Catmull-Rom smoothing rounds off the corners.
+// Distances are in widget pixels.
+class StrokeProcessor
+{
+public:
+    StrokeProcessor();
+
+    void setMinDistance(qreal pixels) { minDistance = pixels; }
+    void setAngleTolerance(qreal degrees);
+    void setSimplifyTolerance(qreal pixels) { simplifyTolerance = pixels; }
+    void setSmoothing(bool enabled) { smoothing = enabled; }
+    bool smoothingEnabled() const { return smoothing; }
+
+    void begin(const QPointF &point);
+    // Returns the index of the first vertex that changed, or -1 if the point was dropped
+    int addPoint(const QPointF &point);
+    // Simplified (and smoothed) stroke; the live stroke is reset
+    QPolygonF finish();
+    void clear() { live.clear(); }
+
+    const QPolygonF &points() const { return live; }
+    bool isEmpty() const { return live.isEmpty(); }
+
+    static QPolygonF simplify(const QPolygonF &points, qreal tolerance);
+    static QPolygonF smooth(const QPolygonF &points, qreal maxSegment);
+
+private:
+    QPolygonF live;
+    qreal minDistance;
+    qreal minCosine; // Cosine of the angle tolerance
+    qreal simplifyTolerance;
+    bool smoothing;
+
+    // Directions the current run's chord may take (radians relative to runAngle)
+    // while keeping every vertex it replaced within simplifyTolerance
+    void startRun();
+    qreal runAngle;
+    qreal coneLow;
+    qreal coneHigh;
+};
+
+#endif // STROKEPROCESSOR_H
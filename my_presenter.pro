@@ -1,4 +1,4 @@
-QT       += core gui widgets pdf pdfwidgets
+QT       += core gui widgets pdf pdfwidgets openglwidgets
 
 TARGET   = app
 TEMPLATE = app
@@ -15,13 +15,39 @@ SOURCES += src/main.cpp \
            src/mainwindow.cpp \
            src/presentationdisplay.cpp \
            src/screenselectorwidget.cpp \
-           src/flowlayout.cpp
+           src/flowlayout.cpp \
+           src/sliderenderer.cpp \
+           src/documentloader.cpp \
+           src/searchindex.cpp \
+           src/slidecache.cpp \
+           src/rasterdiskcache.cpp \
+           src/slidepackage.cpp \
+           src/slidesorter.cpp \
+           src/slideprefetcher.cpp \
+           src/annotationstore.cpp \
+           src/strokeprocessor.cpp \
+           src/renderprofiler.cpp \
+           src/audienceglsurface.cpp \
+           src/batchrenderer.cpp
 
 # Header files
 HEADERS += include/mainwindow.h \
            include/presentationdisplay.h \
            include/screenselectorwidget.h \
-           include/flowlayout.h
+           include/flowlayout.h \
+           include/sliderenderer.h \
+           include/documentloader.h \
+           include/searchindex.h \
+           include/slidecache.h \
+           include/rasterdiskcache.h \
+           include/slidepackage.h \
+           include/slidesorter.h \
+           include/slideprefetcher.h \
+           include/annotationstore.h \
+           include/strokeprocessor.h \
+           include/renderprofiler.h \
+           include/audienceglsurface.h \
+           include/batchrenderer.h
 
 # Include paths
 INCLUDEPATH += include
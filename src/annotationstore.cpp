@@ -0,0 +1,319 @@
+#include "annotationstore.h"
+#include <QSaveFile>
+#include <cstring>
+
+namespace {
+// Sidecar layout, all fields 32-bit in native byte order (a foreign byte order
+// fails the magic check and the file is ignored):
+//   header       magic, version, pageCount, paletteCount, strokeCount, pointCount
+//   page table   pageCount x (first stroke, stroke count)
+//   palette      paletteCount x (rgba, width as float, pen style)
+//   first point  strokeCount + 1 indexes into the point buffer
+//   pens         strokeCount palette indexes
+//   points       pointCount x (x, y) as float
+const quint32 kMagic = 0x4E41504D; // "MPAN"
+const quint32 kVersion = 1;
+const int kHeaderWords = 6;
+const int kPenWords = 3;
+
+template <typename T>
+void writeArray(QSaveFile &out, const T *data, qsizetype count)
+{
+    if (count > 0) out.write(reinterpret_cast<const char *>(data), count * qsizetype(sizeof(T)));
+}
+}
+
+AnnotationStore::AnnotationStore()
+    : map(nullptr), mappedPages(0), mappedPalette(0), mappedStrokes(0), mappedPoints(0),
+      pageTable(nullptr), paletteWords(nullptr), firstPoint(nullptr), strokePens(nullptr), points(nullptr),
+      dirty(false)
+{
+}
+
+AnnotationStore::~AnnotationStore()
+{
+    unmap();
+}
+
+QString AnnotationStore::sidecarPath(const QString &pdfPath)
+{
+    return pdfPath + ".annotations";
+}
+
+void AnnotationStore::open(const QString &filePath)
+{
+    close();
+    path = filePath;
+    if (!mapFile()) return;
+
+    // The palette is tiny (one entry per distinct pen), so it is copied out
+    palette.resize(mappedPalette);
+    for (quint32 i = 0; i < mappedPalette; ++i) {
+        const quint32 *words = paletteWords + kPenWords * i;
+        palette[i].color = words[0];
+        std::memcpy(&palette[i].width, &words[1], sizeof(float));
+        palette[i].style = words[2];
+    }
+}
+
+bool AnnotationStore::mapFile()
+{
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const qint64 size = file.size();
+    if (size < qint64(kHeaderWords * sizeof(quint32))) {
+        file.close();
+        return false;
+    }
+    quint32 header[kHeaderWords];
+    file.read(reinterpret_cast<char *>(header), sizeof(header));
+    const quint32 pageCount = header[2], paletteCount = header[3];
+    const quint32 strokeCount = header[4], pointCount = header[5];
+
+    // Section sizes first; per-page ranges are checked on access
+    const qint64 words = qint64(kHeaderWords) + 2LL * pageCount + qint64(kPenWords) * paletteCount
+                       + (strokeCount + 1LL) + strokeCount + 2LL * pointCount;
+    if (header[0] != kMagic || header[1] != kVersion || words * qint64(sizeof(quint32)) != size) {
+        qWarning("Ignoring unreadable annotation file %s", qPrintable(path));
+        file.close();
+        return false;
+    }
+
+    map = file.map(0, size);
+    if (!map) {
+        file.close();
+        return false;
+    }
+    const quint32 *base = reinterpret_cast<const quint32 *>(map);
+
+    // Pages are sliced straight out of the point buffer by these indexes, so a
+    // corrupt file must not get past this point
+    const quint32 *offsets = base + kHeaderWords + 2 * pageCount + kPenWords * paletteCount;
+    bool ordered = offsets[strokeCount] <= pointCount;
+    for (quint32 i = 0; ordered && i < strokeCount; ++i) ordered = offsets[i] <= offsets[i + 1];
+    if (!ordered) {
+        qWarning("Ignoring unreadable annotation file %s", qPrintable(path));
+        file.unmap(map);
+        map = nullptr;
+        file.close();
+        return false;
+    }
+    mappedPages = pageCount;
+    mappedPalette = paletteCount;
+    mappedStrokes = strokeCount;
+    mappedPoints = pointCount;
+    pageTable = base + kHeaderWords;
+    paletteWords = pageTable + 2 * pageCount;
+    firstPoint = paletteWords + kPenWords * paletteCount;
+    strokePens = firstPoint + strokeCount + 1;
+    points = reinterpret_cast<const float *>(strokePens + strokeCount);
+    return true;
+}
+
+void AnnotationStore::unmap()
+{
+    if (map) file.unmap(map);
+    file.close();
+    map = nullptr;
+    mappedPages = 0;
+    mappedPalette = 0;
+    mappedStrokes = 0;
+    mappedPoints = 0;
+    pageTable = nullptr;
+    paletteWords = nullptr;
+    firstPoint = nullptr;
+    strokePens = nullptr;
+    points = nullptr;
+}
+
+void AnnotationStore::close()
+{
+    unmap();
+    path.clear();
+    palette.clear();
+    edited.clear();
+    dirty = false;
+}
+
+AnnotationStore::PageView AnnotationStore::view(int page) const
+{
+    PageView v;
+    auto it = edited.constFind(page);
+    if (it != edited.constEnd()) {
+        v.firstPoint = it->firstPoint.constData();
+        v.pens = it->pens.constData();
+        v.points = it->points.constData();
+        v.strokes = it->pens.size();
+        v.pointCount = quint32(it->points.size() / 2);
+        return v;
+    }
+    if (page < 0 || quint32(page) >= mappedPages) return v;
+
+    const quint32 first = pageTable[2 * page];
+    const quint32 count = pageTable[2 * page + 1];
+    if (qint64(first) + count > mappedStrokes) return v;
+
+    // Mapped point indexes are global, so the view keeps the global point base
+    v.firstPoint = firstPoint + first;
+    v.pens = strokePens + first;
+    v.points = points;
+    v.strokes = int(count);
+    v.pointCount = mappedPoints;
+    return v;
+}
+
+int AnnotationStore::strokeCount(int page) const
+{
+    return view(page).strokes;
+}
+
+QPolygonF AnnotationStore::strokePoints(int page, int stroke) const
+{
+    const PageView v = view(page);
+    if (stroke < 0 || stroke >= v.strokes) return QPolygonF();
+
+    const quint32 from = v.firstPoint[stroke];
+    const quint32 to = v.firstPoint[stroke + 1];
+    if (from > to || to > v.pointCount) return QPolygonF();
+
+    QPolygonF polygon;
+    polygon.reserve(to - from);
+    for (quint32 i = from; i < to; ++i) {
+        polygon.append(QPointF(v.points[2 * i], v.points[2 * i + 1]));
+    }
+    return polygon;
+}
+
+AnnotationPen AnnotationStore::strokePen(int page, int stroke) const
+{
+    const PageView v = view(page);
+    if (stroke < 0 || stroke >= v.strokes) return AnnotationPen();
+    return palette.value(v.pens[stroke]);
+}
+
+AnnotationStore::Page &AnnotationStore::editablePage(int page)
+{
+    auto it = edited.find(page);
+    if (it != edited.end()) return *it;
+
+    // First edit of a mapped page: copy it out, rebasing its point indexes to zero
+    Page copy;
+    const PageView v = view(page);
+    if (v.strokes > 0) {
+        const quint32 base = v.firstPoint[0];
+        copy.firstPoint.clear();
+        for (int i = 0; i <= v.strokes; ++i) copy.firstPoint.append(v.firstPoint[i] - base);
+        copy.pens = QList<quint32>(v.pens, v.pens + v.strokes);
+        copy.points = QList<float>(v.points + 2 * base, v.points + 2 * v.firstPoint[v.strokes]);
+    }
+    return edited.insert(page, copy).value();
+}
+
+quint32 AnnotationStore::paletteIndex(const AnnotationPen &pen)
+{
+    qsizetype index = palette.indexOf(pen);
+    if (index < 0) {
+        palette.append(pen);
+        index = palette.size() - 1;
+    }
+    return quint32(index);
+}
+
+void AnnotationStore::addStroke(int page, const QPolygonF &stroke, const AnnotationPen &pen)
+{
+    if (page < 0 || stroke.isEmpty()) return;
+    const quint32 penIndex = paletteIndex(pen);
+    Page &p = editablePage(page);
+    p.points.reserve(p.points.size() + 2 * stroke.size());
+    for (const QPointF &pt : stroke) {
+        p.points.append(float(pt.x()));
+        p.points.append(float(pt.y()));
+    }
+    p.pens.append(penIndex);
+    p.firstPoint.append(quint32(p.points.size() / 2));
+    dirty = true;
+}
+
+void AnnotationStore::clearPage(int page)
+{
+    if (strokeCount(page) == 0) return;
+    edited.insert(page, Page());
+    dirty = true;
+}
+
+bool AnnotationStore::save()
+{
+    if (!dirty) return true;
+    if (path.isEmpty()) return false;
+
+    quint32 pageCount = mappedPages;
+    for (auto it = edited.constBegin(); it != edited.constEnd(); ++it) {
+        pageCount = qMax(pageCount, quint32(it.key() + 1));
+    }
+
+    QList<PageView> pages;
+    pages.reserve(pageCount);
+    QList<quint32> table;
+    table.reserve(2 * pageCount);
+    quint32 totalStrokes = 0, totalPoints = 0;
+    for (quint32 page = 0; page < pageCount; ++page) {
+        const PageView v = view(int(page));
+        pages.append(v);
+        table.append(totalStrokes);
+        table.append(quint32(v.strokes));
+        totalStrokes += v.strokes;
+        if (v.strokes > 0) totalPoints += v.firstPoint[v.strokes] - v.firstPoint[0];
+    }
+
+    QSaveFile out(path);
+    if (!out.open(QIODevice::WriteOnly)) {
+        qWarning("Cannot save annotations to %s: %s", qPrintable(path), qPrintable(out.errorString()));
+        return false;
+    }
+
+    const quint32 header[kHeaderWords] = { kMagic, kVersion, pageCount, quint32(palette.size()), totalStrokes, totalPoints };
+    writeArray(out, header, kHeaderWords);
+    writeArray(out, table.constData(), table.size());
+
+    QList<quint32> penWords;
+    penWords.reserve(kPenWords * palette.size());
+    for (const AnnotationPen &pen : palette) {
+        quint32 width;
+        std::memcpy(&width, &pen.width, sizeof(float));
+        penWords << pen.color << width << pen.style;
+    }
+    writeArray(out, penWords.constData(), penWords.size());
+
+    // Point indexes become global across the whole file
+    QList<quint32> offsets;
+    offsets.reserve(totalStrokes + 1);
+    quint32 nextPoint = 0;
+    for (const PageView &v : pages) {
+        for (int i = 0; i < v.strokes; ++i) {
+            offsets.append(nextPoint + v.firstPoint[i] - v.firstPoint[0]);
+        }
+        if (v.strokes > 0) nextPoint += v.firstPoint[v.strokes] - v.firstPoint[0];
+    }
+    offsets.append(nextPoint);
+    writeArray(out, offsets.constData(), offsets.size());
+
+    for (const PageView &v : pages) writeArray(out, v.pens, v.strokes);
+    for (const PageView &v : pages) {
+        if (v.strokes == 0) continue;
+        writeArray(out, v.points + 2 * v.firstPoint[0], 2 * qsizetype(v.firstPoint[v.strokes] - v.firstPoint[0]));
+    }
+
+    // The page views point into the mapping, so it may only go away once everything is written.
+    // Replacing a mapped file fails on some platforms, hence unmapping before the commit.
+    unmap();
+    const bool ok = out.commit();
+    if (!ok) qWarning("Cannot save annotations to %s: %s", qPrintable(path), qPrintable(out.errorString()));
+    // Map whichever file is now on disk. On failure that is the old one, and the edits stay in memory.
+    mapFile();
+    if (ok) {
+        edited.clear();
+        dirty = false;
+    }
+    return ok;
+}
@@ -0,0 +1,16 @@
+#include "audienceglsurface.h"
+#include <QPainter>
+
+AudienceGLSurface::AudienceGLSurface(const ScenePainter &paintScene, QWidget *parent)
+    : QOpenGLWidget(parent), paintScene(paintScene)
+{
+    // Input and cursors stay with the parent
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setFocusPolicy(Qt::NoFocus);
+}
+
+void AudienceGLSurface::paintGL()
+{
+    QPainter painter(this);
+    paintScene(painter, rect());
+}
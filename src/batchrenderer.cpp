@@ -0,0 +1,168 @@
+#include "batchrenderer.h"
+#include "sliderenderer.h"
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QImageWriter>
+#include <QPdfDocument>
+#include <QSet>
+#include <QThread>
+#include <QThreadPool>
+#include <atomic>
+
+BatchRenderer::BatchRenderer(const BatchRenderOptions &options)
+    : options(options)
+{
+}
+
+bool BatchRenderer::parsePages(const QString &spec, int pageCount, QList<int> *pages)
+{
+    pages->clear();
+    if (spec.trimmed().isEmpty()) {
+        for (int i = 0; i < pageCount; ++i) pages->append(i);
+        return true;
+    }
+
+    QSet<int> seen;
+    const QStringList parts = spec.split(',', Qt::SkipEmptyParts);
+    for (const QString &part : parts) {
+        const QString range = part.trimmed();
+        int dash = range.indexOf('-');
+        bool okFirst = true, okLast = true;
+        int first, last;
+        if (dash < 0) {
+            first = last = range.toInt(&okFirst);
+        } else {
+            // "-5" and "10-" are open ranges
+            first = dash == 0 ? 1 : range.left(dash).toInt(&okFirst);
+            last = dash == range.size() - 1 ? pageCount : range.mid(dash + 1).toInt(&okLast);
+        }
+        if (!okFirst || !okLast || first < 1 || last < first || last > pageCount) return false;
+        for (int p = first; p <= last; ++p) {
+            if (!seen.contains(p - 1)) {
+                seen.insert(p - 1);
+                pages->append(p - 1);
+            }
+        }
+    }
+    return !pages->isEmpty();
+}
+
+QSize BatchRenderer::parseSize(const QString &text)
+{
+    const QStringList parts = text.toLower().split('x');
+    if (parts.size() != 2) return QSize();
+    bool okW, okH;
+    QSize size(parts[0].toInt(&okW), parts[1].toInt(&okH));
+    return okW && okH && !size.isEmpty() ? size : QSize();
+}
+
+QString BatchRenderer::fileNameFor(const Job &job, int pageCount) const
+{
+    // talk-007-1920x1080-notes.png; the padding keeps files sorted by page
+    const int digits = qMax(3, int(QString::number(pageCount).size()));
+    QString name = QString("%1-%2-%3x%4")
+                       .arg(QFileInfo(options.sourcePath).completeBaseName())
+                       .arg(job.page + 1, digits, 10, QChar('0'))
+                       .arg(job.box.width())
+                       .arg(job.box.height());
+    if (job.half == BatchRenderOptions::Split::Slide) name += "-slide";
+    if (job.half == BatchRenderOptions::Split::Notes) name += "-notes";
+    return QDir(options.outputDir).filePath(name + '.' + QString::fromLatin1(options.format));
+}
+
+int BatchRenderer::run()
+{
+    if (!QImageWriter::supportedImageFormats().contains(options.format)) {
+        qCritical("Image format '%s' is not supported by this Qt installation", options.format.constData());
+        return -1;
+    }
+    if (options.sizes.isEmpty()) {
+        qCritical("No output size given");
+        return -1;
+    }
+    if (!QDir().mkpath(options.outputDir)) {
+        qCritical("Cannot create output directory %s", qPrintable(options.outputDir));
+        return -1;
+    }
+
+    // Only used for the page count; workers open their own copies
+    int pageCount;
+    {
+        QPdfDocument probe;
+        if (probe.load(options.sourcePath) != QPdfDocument::Error::None) {
+            qCritical("Cannot open %s", qPrintable(options.sourcePath));
+            return -1;
+        }
+        pageCount = probe.pageCount();
+    }
+
+    QList<int> pages;
+    if (!parsePages(options.pages, pageCount, &pages)) {
+        qCritical("Invalid page selection '%s' (document has %d pages)", qPrintable(options.pages), pageCount);
+        return -1;
+    }
+
+    QList<BatchRenderOptions::Split> halves;
+    switch (options.split) {
+    case BatchRenderOptions::Split::None: halves = { BatchRenderOptions::Split::None }; break;
+    case BatchRenderOptions::Split::Slide: halves = { BatchRenderOptions::Split::Slide }; break;
+    case BatchRenderOptions::Split::Notes: halves = { BatchRenderOptions::Split::Notes }; break;
+    case BatchRenderOptions::Split::Both:
+        halves = { BatchRenderOptions::Split::Slide, BatchRenderOptions::Split::Notes };
+        break;
+    }
+
+    QList<Job> jobs;
+    for (int page : pages) {
+        for (const QSize &box : options.sizes) {
+            for (BatchRenderOptions::Split half : halves) jobs.append(Job{ page, box, half });
+        }
+    }
+
+    const int workers = qBound(1, options.jobs > 0 ? options.jobs : QThread::idealThreadCount(), int(jobs.size()));
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers);
+
+    std::atomic<int> next{0};
+    std::atomic<int> written{0};
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int w = 0; w < workers; ++w) {
+        pool.start([this, &jobs, &next, &written, pageCount]() {
+            // One document per worker: PDFium state is never shared between threads
+            QPdfDocument document;
+            if (document.load(options.sourcePath) != QPdfDocument::Error::None) return;
+
+            for (int i = next.fetch_add(1); i < jobs.size(); i = next.fetch_add(1)) {
+                const Job &job = jobs[i];
+                QRectF crop(0, 0, 1, 1);
+                if (job.half == BatchRenderOptions::Split::Slide) crop = QRectF(0, 0, 0.5, 1);
+                if (job.half == BatchRenderOptions::Split::Notes) crop = QRectF(0.5, 0, 0.5, 1);
+
+                RenderRequest request = RenderRequest::fitted(job.page, document.pagePointSize(job.page), job.box, crop);
+                QImage image = SlideRenderer::rasterize(&document, request);
+                const QString fileName = fileNameFor(job, pageCount);
+                if (image.isNull()) {
+                    qWarning("Failed to render page %d", job.page + 1);
+                    continue;
+                }
+
+                QImageWriter writer(fileName, options.format);
+                if (options.quality >= 0) writer.setQuality(options.quality);
+                if (!writer.write(image)) {
+                    qWarning("Cannot write %s: %s", qPrintable(fileName), qPrintable(writer.errorString()));
+                    continue;
+                }
+                ++written;
+            }
+        });
+    }
+    pool.waitForDone();
+
+    const double seconds = timer.elapsed() / 1000.0;
+    qInfo("Rendered %d of %d images in %.2f s (%.1f images/s, %d workers)", written.load(), int(jobs.size()),
+          seconds, seconds > 0 ? written.load() / seconds : 0.0, workers);
+    return int(jobs.size()) - written.load();
+}
@@ -0,0 +1,99 @@
+#include "documentloader.h"
+#include "renderprofiler.h"
+#include <QPdfBookmarkModel>
+#include <QPdfDocument>
+#include <QPdfSelection>
+#include <QThread>
+
+namespace {
+const int kIndexProgressStep = 16;
+}
+
+DocumentLoader::DocumentLoader(QObject *parent)
+    : QObject(parent), generation(0)
+{
+    workerThread = new QThread(this);
+    workerThread->setObjectName("DocumentLoader");
+    context = new QObject();
+    context->moveToThread(workerThread);
+    connect(workerThread, &QThread::finished, context, &QObject::deleteLater);
+    workerThread->start();
+}
+
+DocumentLoader::~DocumentLoader()
+{
+    ++generation; // Stops indexing early
+    workerThread->quit();
+    workerThread->wait();
+}
+
+void DocumentLoader::cancel()
+{
+    ++generation;
+}
+
+void DocumentLoader::load(const QString &filePath)
+{
+    const quint64 loadGeneration = ++generation;
+    QThread *guiThread = thread();
+    QMetaObject::invokeMethod(context, [this, filePath, loadGeneration, guiThread]() {
+        if (loadGeneration != generation) return; // Cancelled before it started
+        QPdfDocument *document = new QPdfDocument();
+        QPdfBookmarkModel *bookmarks = new QPdfBookmarkModel();
+        {
+            ProfileScope scope("bookmark load");
+            document->load(filePath);
+            // The tree is built right here, while the document is still on this thread
+            bookmarks->setDocument(document);
+        }
+        document->moveToThread(guiThread);
+        bookmarks->moveToThread(guiThread);
+
+        QMetaObject::invokeMethod(this, [this, document, bookmarks, loadGeneration]() {
+            if (loadGeneration != generation) {
+                delete bookmarks;
+                delete document;
+                return;
+            }
+            emit loaded(document, bookmarks);
+        }, Qt::QueuedConnection);
+
+        // The document above now belongs to the GUI thread, so the text comes from a
+        // copy of our own. Every page is a separate PDFium call, which lets slide
+        // renders interleave instead of waiting for the whole deck.
+        QPdfDocument textSource;
+        if (textSource.load(filePath) != QPdfDocument::Error::None) return;
+        SearchIndex index;
+        const int count = textSource.pageCount();
+        for (int page = 0; page < count; ++page) {
+            if (loadGeneration != generation) return; // Another deck was opened meanwhile
+            {
+                ProfileScope scope("text extraction");
+                const QString text = textSource.getAllText(page).text();
+                // Word outlines for search highlights, so the GUI never asks PDFium for them
+                QList<QPair<int, int>> spans;
+                SearchIndex::tokenize(text, &spans);
+                const QSizeF pageSize = textSource.pagePointSize(page);
+                QList<QRectF> boxes;
+                boxes.reserve(spans.size());
+                for (const QPair<int, int> &span : spans) {
+                    const QRectF r = textSource.getSelectionAtIndex(page, span.first, span.second).boundingRectangle();
+                    boxes.append(pageSize.isEmpty() ? QRectF()
+                                                    : QRectF(r.x() / pageSize.width(), r.y() / pageSize.height(),
+                                                             r.width() / pageSize.width(), r.height() / pageSize.height()));
+                }
+                index.addPage(page, text, boxes);
+            }
+            if ((page + 1) % kIndexProgressStep == 0 || page + 1 == count) {
+                QMetaObject::invokeMethod(this, [this, page, count, loadGeneration]() {
+                    if (loadGeneration == generation) emit indexProgress(page + 1, count);
+                }, Qt::QueuedConnection);
+            }
+        }
+        index.finalize();
+
+        QMetaObject::invokeMethod(this, [this, index, loadGeneration]() {
+            if (loadGeneration == generation) emit indexed(index);
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
@@ -1,12 +1,139 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QScopedPointer>
+#include <QSet>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include "mainwindow.h"
+#include "batchrenderer.h"
+#include "slidepackage.h"
+#include "renderprofiler.h"
+
+namespace {
+// Batch export needs no windows, so it must not require a display either
+bool wantsBatchRender(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; ++i) {
+        const QByteArray arg(argv[i]);
+        if (arg.startsWith("--render-out") || arg.startsWith("--compile")) return true;
+    }
+    return false;
+}
+
+// Where startup time went, in time order. Stages are shown individually; for
+// everything else only the first occurrence (first PDF load, first render, ...).
+void printStartupTrace()
+{
+    QList<RenderProfiler::Event> events = RenderProfiler::events();
+    std::sort(events.begin(), events.end(), [](const RenderProfiler::Event &a, const RenderProfiler::Event &b) {
+        return a.startNs < b.startNs;
+    });
+
+    QSet<QByteArray> seen;
+    qint64 end = 0;
+    fprintf(stderr, "Startup trace (ms since launch)\n%9s %9s  %-16s %s\n", "start", "duration", "thread", "stage");
+    for (const RenderProfiler::Event &e : events) {
+        if (!e.name) continue;
+        const bool stage = std::strncmp(e.name, "startup", 7) == 0;
+        if (!stage) {
+            if (seen.contains(QByteArray(e.name))) continue;
+            seen.insert(QByteArray(e.name));
+        }
+        fprintf(stderr, "%9.1f %9.1f  %-16s %s\n", e.startNs / 1e6, e.durationNs / 1e6,
+                qPrintable(RenderProfiler::threadName(e.thread)), e.name);
+        end = qMax(end, e.startNs + e.durationNs);
+    }
+    fprintf(stderr, "Ready after %.1f ms\n", end / 1e6);
+}
+}
 
 int main(int argc, char *argv[])
 {
-    QApplication app(argc, argv);
+    const qint64 launch = RenderProfiler::now(); // Starts the profiler clock
+    QScopedPointer<QCoreApplication> app(wantsBatchRender(argc, argv) ? new QCoreApplication(argc, argv)
+                                                                      : new QApplication(argc, argv));
+    RenderProfiler::record("startup: application", launch, RenderProfiler::now() - launch);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("PDF presenter with console and audience windows");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "PDF to open.", "[file.pdf]");
+
+    QCommandLineOption outOption("render-out", "Export slides as images into <dir> instead of presenting.", "dir");
+    QCommandLineOption pagesOption("pages", "Pages to export, e.g. 1-3,7,10- (default: all).", "list");
+    QCommandLineOption sizeOption("size", "Fit slides into WIDTHxHEIGHT (repeatable, default 1920x1080).", "size");
+    QCommandLineOption splitOption("split", "Beamer notes pages: export the slide half, the notes half, or both.", "none|slide|notes|both", "none");
+    QCommandLineOption formatOption("format", "Image format, e.g. png, jpg, webp.", "format", "png");
+    QCommandLineOption qualityOption("quality", "Encoder quality 0-100 (default: format default).", "quality", "-1");
+    QCommandLineOption jobsOption("jobs", "Parallel workers (default: one per core).", "count", "0");
+    QCommandLineOption traceOption("startup-trace", "Print where startup time goes once the first slide is shown.");
+    QCommandLineOption compileOption("compile", "Pre-render every slide at --size into a playback package <file> instead of presenting.", "file");
+    QCommandLineOption packageOption("package", "Show the audience window from a package made with --compile.", "file");
+    parser.addOptions({ outOption, pagesOption, sizeOption, splitOption, formatOption, qualityOption, jobsOption, traceOption,
+                        compileOption, packageOption });
+    parser.process(*app);
+
+    const QStringList files = parser.positionalArguments();
+    if (parser.isSet(outOption)) {
+        if (files.size() != 1) {
+            qCritical("--render-out needs exactly one PDF file");
+            return 2;
+        }
+
+        BatchRenderOptions options;
+        options.sourcePath = files.first();
+        options.outputDir = parser.value(outOption);
+        options.pages = parser.value(pagesOption);
+        options.format = parser.value(formatOption).toLower().toLatin1();
+        options.quality = parser.value(qualityOption).toInt();
+        options.jobs = parser.value(jobsOption).toInt();
+
+        const QStringList sizes = parser.isSet(sizeOption) ? parser.values(sizeOption) : QStringList{ "1920x1080" };
+        for (const QString &text : sizes) {
+            QSize size = BatchRenderer::parseSize(text);
+            if (!size.isValid()) {
+                qCritical("Invalid size '%s', expected WIDTHxHEIGHT", qPrintable(text));
+                return 2;
+            }
+            options.sizes.append(size);
+        }
+
+        const QString split = parser.value(splitOption).toLower();
+        if (split == "slide") options.split = BatchRenderOptions::Split::Slide;
+        else if (split == "notes") options.split = BatchRenderOptions::Split::Notes;
+        else if (split == "both") options.split = BatchRenderOptions::Split::Both;
+        else if (split != "none") {
+            qCritical("Invalid --split '%s', expected none, slide, notes or both", qPrintable(split));
+            return 2;
+        }
+
+        return BatchRenderer(options).run() == 0 ? 0 : 1;
+    }
+
+    if (parser.isSet(compileOption)) {
+        if (files.size() != 1) {
+            qCritical("--compile needs exactly one PDF file");
+            return 2;
+        }
+        // One package plays at one resolution: the projector's
+        const QString sizeText = parser.isSet(sizeOption) ? parser.value(sizeOption) : QString("1920x1080");
+        const QSize size = BatchRenderer::parseSize(sizeText);
+        if (!size.isValid()) {
+            qCritical("Invalid size '%s', expected WIDTHxHEIGHT", qPrintable(sizeText));
+            return 2;
+        }
+        return SlidePackage::build(files.first(), parser.value(compileOption), size, parser.value(jobsOption).toInt()) == 0 ? 0 : 1;
+    }
 
-    MainWindow w;
+    const qint64 windowStart = RenderProfiler::now();
+    MainWindow w(nullptr, files.isEmpty() ? QString() : files.first());
+    if (parser.isSet(packageOption) && !w.openSlidePackage(parser.value(packageOption))) {
+        qWarning("Cannot open slide package %s; rendering live", qPrintable(parser.value(packageOption)));
+    }
     w.show();
+    RenderProfiler::record("startup: windows", windowStart, RenderProfiler::now() - windowStart);
+    if (parser.isSet(traceOption)) QObject::connect(&w, &MainWindow::startupComplete, printStartupTrace);
 
-    return app.exec();
+    return app->exec();
 }
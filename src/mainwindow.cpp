@@ -1,5 +1,7 @@
 #include "mainwindow.h"
 #include "flowlayout.h"
+#include "renderprofiler.h"
+#include "rasterdiskcache.h"
 #include <QFileDialog>
 #include <QScreen>
 #include <QGuiApplication>
@@ -10,62 +12,146 @@
 #include <QMessageBox>
 #include <QStackedLayout>
 #include <QSettings>
+#include <QStatusBar>
+#include <algorithm>
 
-MainWindow::MainWindow(QWidget *parent)
-    : QMainWindow(parent), currentPage(0), showLaser(false), useSplitView(false), timerRunning(false), timerHasStarted(false)
+MainWindow::MainWindow(QWidget *parent, const QString &initialFile)
+    : QMainWindow(parent), loadStart(0), awaitingFirstSlide(!initialFile.isEmpty()), startupDone(false), currentTicket(0), notesTicket(0), nextTicket(0), settling(false), audienceReady(false), settleStart(0), packageCheck(0), packageKeyPending(false), currentPage(0), showLaser(false), useSplitView(false), timerRunning(false), timerHasStarted(false)
 {
+    // Built by deferred startup stages
+    tocView = nullptr;
+    searchBox = nullptr;
+    searchResults = nullptr;
+    slideSorter = nullptr;
+    switchScreenButton = nullptr;
+    screenSelector = nullptr;
+
+    // Empty until the background loader delivers the document of a deck
     pdf = new QPdfDocument(this);
     bookmarkModel = new QPdfBookmarkModel(this);
     bookmarkModel->setDocument(pdf);
+    tocStale = true;
+    watchBookmarks();
+    documentLoader = new DocumentLoader(this);
+    connect(documentLoader, &DocumentLoader::loaded, this, &MainWindow::onDocumentLoaded);
+    connect(documentLoader, &DocumentLoader::indexProgress, this, &MainWindow::onIndexProgress);
+    connect(documentLoader, &DocumentLoader::indexed, this, &MainWindow::onSearchIndexed);
+
+    // Background rendering shared by console and audience views; it also opens the deck
+    renderer = new SlideRenderer(this);
+    connect(renderer, &SlideRenderer::imageReady, this, &MainWindow::onSlideRendered);
+    connect(renderer, &SlideRenderer::loadProgress, this, &MainWindow::onLoadProgress);
+    connect(renderer, &SlideRenderer::contentKeyReady, this, [this](const QByteArray &key) {
+        onPackageKey(packageCheck, key);
+    });
+    connect(renderer, &SlideRenderer::loadFailed, this, [this](){
+        showLoadStatus(QString());
+        const QString failedFile = loadingFile;
+        loadingFile.clear();
+        awaitingFirstSlide = false;
+        checkStartupComplete();
+        QMessageBox::warning(this, "Open Failed", "Could not open " + failedFile);
+    });
+
     // PresentationDisplay setup
     presentationDisplay = new PresentationDisplay(nullptr);
-    presentationDisplay->setDocument(pdf);
-    presentationDisplay->installEventFilter(this); // Capture keys from audience window
+    presentationDisplay->setRenderer(renderer);
+
+    annotations = new AnnotationStore();
+    presentationDisplay->setAnnotationStore(annotations);
+
+    // Pre-render neighbouring pages, audience window first
+    prefetcher = new SlidePrefetcher(renderer);
+    prefetcher->addTarget([this](int page) { return presentationDisplay->requestForPage(page); });
+    prefetcher->addTarget([this](int page) { return consoleRequestForPage(page); });
+    prefetcher->addTarget([this](int page) { return notesRequestForPage(page); });
+    // Arriving at 'page' shows 'page + 1' in the next-slide preview
+    prefetcher->addTarget([this](int page) { return previewRequestForPage(page + 1); });
 
     clockTimer = new QTimer(this);
     connect(clockTimer, &QTimer::timeout, this, &MainWindow::updateTimers);
-    clockTimer->start(1000);
 
     // Timer starts manually via button/hotkey or first slide change
     resizeTimer = new QTimer(this);
     resizeTimer->setSingleShot(true);
     connect(resizeTimer, &QTimer::timeout, this, &MainWindow::updateViews);
 
-    setupUi();
-
-    // Setup shortcuts for both windows
-    setupShortcuts();
+    // The renderer snapshots page geometry first, so react to it rather than to the document
+    connect(renderer, &SlideRenderer::documentReady, this, &MainWindow::onDocumentReady);
 
-    detectScreens();
-
-    if (windowHandle()) {
-         connect(windowHandle(), &QWindow::screenChanged, this, &MainWindow::updateScreenControls);
+    // Staged startup: only what the first slide needs is built here. The deck starts
+    // loading on a render thread right away, and the secondary panels are built one
+    // per event-loop turn while it loads, so none of them delays the first frame.
+    {
+        ProfileScope scope("startup: console");
+        setupUi();
+    }
+    {
+        ProfileScope scope("startup: audience window");
+        loadEarlySettings();
+        placeAudienceWindow();
+    }
+    if (!initialFile.isEmpty()) {
+        loadPdf(initialFile);
+    } else {
+        QTimer::singleShot(0, this, [this](){
+            // Not modal-blocking: both windows keep painting while the presenter picks a file
+            QFileDialog *dialog = new QFileDialog(this, "Open PDF", "", "PDF Files (*.pdf)");
+            dialog->setAttribute(Qt::WA_DeleteOnClose);
+            dialog->setFileMode(QFileDialog::ExistingFile);
+            connect(dialog, &QFileDialog::fileSelected, this, &MainWindow::loadPdf);
+            dialog->open();
+        });
     }
 
-    // Auto-open for convenience
-    QTimer::singleShot(0, this, [this](){
-        QString fileName = QFileDialog::getOpenFileName(this, "Open PDF", "", "PDF Files (*.pdf)");
-        if (!fileName.isEmpty()) {
-            loadPdf(fileName);
-        }
-    });
+    startupStages = {
+        { "startup: search", [this]() { buildSearchPanel(); } },
+        { "startup: chapters", [this]() { buildChaptersPanel(); } },
+        { "startup: monitor manager", [this]() { buildMonitorPanel(); } },
+        { "startup: control center", [this]() { buildControlCenter(); } },
+        { "startup: settings", [this]() { loadSettings(); } },
+        { "startup: shortcuts", [this]() {
+            // Hotkeys drive the panels built above, so they come last
+            setupShortcuts();
+            presentationDisplay->installEventFilter(this); // Capture keys from audience window
+            clockTimer->start(1000);
+            updateTimers();
+        } },
+    };
+    QTimer::singleShot(0, this, &MainWindow::runNextStartupStage);
+}
 
-    connect(pdf, &QPdfDocument::statusChanged, this, [this](QPdfDocument::Status status){
-        if (status == QPdfDocument::Status::Ready) {
-            updateViews();
-            presentationDisplay->setDocument(pdf);
-        }
-    });
+void MainWindow::runNextStartupStage()
+{
+    if (startupStages.isEmpty()) return;
+    const StartupStage stage = startupStages.takeFirst();
+    {
+        ProfileScope scope(stage.name);
+        stage.build();
+    }
+    if (startupStages.isEmpty()) {
+        checkStartupComplete();
+    } else {
+        QTimer::singleShot(0, this, &MainWindow::runNextStartupStage);
+    }
+}
 
-    loadSettings();
+void MainWindow::checkStartupComplete()
+{
+    if (startupDone || !startupStages.isEmpty() || awaitingFirstSlide) return;
+    startupDone = true;
+    emit startupComplete();
 }
 
 MainWindow::~MainWindow()
 {
+    packageHashPool.waitForDone();
+    delete prefetcher;
     if (presentationDisplay) {
         presentationDisplay->close();
         delete presentationDisplay;
     }
+    delete annotations;
 }
 
 void MainWindow::setupShortcuts()
@@ -103,6 +189,14 @@ void MainWindow::setupShortcuts()
 
     new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_S), this, SLOT(toggleSplitView()), nullptr, Qt::ApplicationShortcut);
 
+    // Instrumentation
+    new QShortcut(QKeySequence(Qt::Key_F12), this, SLOT(toggleProfilerHud()), nullptr, Qt::ApplicationShortcut);
+    new QShortcut(QKeySequence(Qt::CTRL | Qt::Key_E), this, SLOT(exportTrace()), nullptr, Qt::ApplicationShortcut);
+
+    // Search and overview
+    new QShortcut(QKeySequence::Find, this, SLOT(focusSearch()), nullptr, Qt::ApplicationShortcut);
+    addToolKeys(Qt::Key_O, SLOT(toggleSlideSorter()));
+
     // Screen Management
     addToolKeys(Qt::Key_S, SLOT(switchScreens()));
 
@@ -130,8 +224,9 @@ void MainWindow::nextSlide()
 {
     if (!timerRunning) toggleTimer();
 
-    if (currentPage < pdf->pageCount() - 1) {
+    if (currentPage < renderer->pageCount() - 1) {
         currentPage++;
+        RenderProfiler::beginPageTurn(currentPage);
         updateViews();
     }
 }
@@ -140,6 +235,7 @@ void MainWindow::prevSlide()
 {
     if (currentPage > 0) {
         currentPage--;
+        RenderProfiler::beginPageTurn(currentPage);
         updateViews();
     }
 }
@@ -148,14 +244,16 @@ void MainWindow::firstSlide()
 {
     if (currentPage != 0) {
         currentPage = 0;
+        RenderProfiler::beginPageTurn(currentPage);
         updateViews();
     }
 }
 
 void MainWindow::lastSlide()
 {
-    if (currentPage != pdf->pageCount() - 1) {
-        currentPage = pdf->pageCount() - 1;
+    if (currentPage != renderer->pageCount() - 1) {
+        currentPage = renderer->pageCount() - 1;
+        RenderProfiler::beginPageTurn(currentPage);
         updateViews();
     }
 }
@@ -196,24 +294,171 @@ void MainWindow::resetLayout()
 
 void MainWindow::setupUi()
 {
-    // Central Widget with Fixed Layout
-    QWidget *centralWidget = new QWidget(this);
-    setCentralWidget(centralWidget);
+    // Central Widget with Fixed Layout; the slide sorter takes its place while open
+    consoleStack = new QStackedWidget(this);
+    setCentralWidget(consoleStack);
+    QWidget *centralWidget = new QWidget();
+    consoleStack->addWidget(centralWidget);
 
     QHBoxLayout *mainLayout = new QHBoxLayout(centralWidget);
     mainLayout->setContentsMargins(0, 0, 0, 0);
     mainLayout->setSpacing(0); // Optional: tighter look? Or default spacing. User said "divide... into 3 parts".
 
     // Define 3 Columns
-    QVBoxLayout *leftLayout = new QVBoxLayout();
+    // The side columns are filled by the deferred startup stages
+    leftColumn = new QVBoxLayout();
     QVBoxLayout *middleLayout = new QVBoxLayout();
-    QVBoxLayout *rightLayout = new QVBoxLayout();
+    rightColumn = new QVBoxLayout();
+
+    // --- MIDDLE COLUMN (50%) ---
+    // Contains: Current Slide (Top), Notes (Bottom)
+
+    // 1. Check currentSlideView
+    QLabel *currentSlideTitle = new QLabel("Current Slide");
+    currentSlideTitle->setStyleSheet("font-weight: bold; padding: 5px;");
+    currentSlideTitle->setAlignment(Qt::AlignCenter);
+
+    currentSlideView = new QLabel("Current Slide");
+    currentSlideView->setAlignment(Qt::AlignCenter);
+    currentSlideView->setStyleSheet("background: #dddddd; border: 1px solid #999;");
+    currentSlideView->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
+    currentSlideView->setMinimumSize(50, 50);
+    currentSlideView->installEventFilter(this);
 
-    // --- LEFT COLUMN (25%) ---
-    // Contains: Chapters (Top), Monitor Manager (Bottom)?
-    // In original: Chapters (LeftDock), ScreenDock (LeftDock).
-    // Let's put them vertically in the left column.
+    // 2. Notes
+    // Previously in notesDock
+    QLabel *notesTitle = new QLabel("Notes"); // Was dock title
+    notesTitle->setStyleSheet("font-weight: bold; background: #ddd; padding: 4px;");
+
+    notesView = new QTextEdit();
+    notesView->setPlaceholderText("Notes for this slide...");
+    // notesView->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored); // Maybe preferred now?
+
+    notesImageView = new QLabel("Notes View");
+    notesImageView->setAlignment(Qt::AlignCenter);
+    notesImageView->setStyleSheet("background: white; border: 1px solid #ccc;");
+    notesImageView->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
+    notesImageView->hide();
+
+    // Tells the presenter whether the projector shows a placeholder or the final raster
+    audienceQualityLabel = new QLabel();
+    audienceQualityLabel->setAlignment(Qt::AlignCenter);
+    audienceQualityLabel->setStyleSheet("color: #555; font-size: 10px;");
+    connect(presentationDisplay, &PresentationDisplay::slideQualityChanged, this, &MainWindow::onAudienceQualityChanged);
+    connect(presentationDisplay, &PresentationDisplay::slideReady, this, [this](int page){
+        if (page != currentPage) return;
+        audienceReady = true;
+        checkViewsSettled();
+
+        // First slide of a new deck is up: time it, then load the bookmarks behind it
+        if (!loadingFile.isEmpty()) {
+            const qint64 end = RenderProfiler::now();
+            RenderProfiler::record("first slide", loadStart, end - loadStart);
+            qInfo("First slide of %s after %.1f ms", qPrintable(QFileInfo(loadingFile).fileName()), (end - loadStart) / 1e6);
+            showLoadStatus("Loading bookmarks...");
+            documentLoader->load(loadingFile);
+            loadingFile.clear();
+            awaitingFirstSlide = false;
+            checkStartupComplete();
+        }
+    });
+    onAudienceQualityChanged(presentationDisplay->slideQuality());
+
+    // Render timings, toggled with F12
+    profilerHud = new QLabel();
+    profilerHud->setAlignment(Qt::AlignCenter);
+    profilerHud->setStyleSheet("color: #036; font-family: monospace; font-size: 10px;");
+    profilerHud->hide();
+
+    // Only visible while a deck loads
+    loadProgressBar = new QProgressBar();
+    loadProgressBar->setMaximumWidth(200);
+    loadProgressBar->setTextVisible(false);
+    statusBar()->addPermanentWidget(loadProgressBar);
+    statusBar()->hide();
+
+    middleLayout->addWidget(currentSlideTitle);
+    middleLayout->addWidget(audienceQualityLabel);
+    middleLayout->addWidget(profilerHud);
+    middleLayout->addWidget(currentSlideView, 2); // Slide takes more space
+    middleLayout->addWidget(notesTitle);
+
+    // Notes Container (Stacking text/image)
+    QStackedLayout *notesStack = new QStackedLayout();
+    notesStack->addWidget(notesView);
+    notesStack->addWidget(notesImageView);
+    QWidget *notesWidget = new QWidget();
+    notesWidget->setLayout(notesStack);
+
+    middleLayout->addWidget(notesWidget, 1); // Notes take less space than slide
+
+
+    // --- RIGHT COLUMN (25%) ---
+    // Contains: Next Slide (Top), Control Center (Bottom)
+
+    // 1. Next Slide
+    QLabel *nextSlideTitle = new QLabel("Next Slide");
+    nextSlideTitle->setStyleSheet("font-weight: bold; padding: 5px;");
+    nextSlideTitle->setAlignment(Qt::AlignCenter);
+
+    nextSlideView = new QLabel("Next Slide");
+    nextSlideView->setAlignment(Qt::AlignCenter);
+    nextSlideView->setStyleSheet("background: #eeeeee; border: 1px dashed #aaa;");
+    nextSlideView->setMinimumHeight(150);
+    nextSlideView->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
+
+    rightColumn->addWidget(nextSlideTitle);
+    rightColumn->addWidget(nextSlideView, 2);
+
+    // --- COMPOSE MAIN ---
+    // Stretches: 1 (25%), 2 (50%), 1 (25%) -> Total 4 parts.
+    // 1/4 = 25%, 2/4 = 50%, 1/4 = 25%.
 
+    // Wrap layouts in widgets or add directly as layouts?
+    // QHBoxLayout::addLayout allows adding layouts.
+
+    mainLayout->addLayout(leftColumn, 1);
+    mainLayout->addLayout(middleLayout, 2);
+    mainLayout->addLayout(rightColumn, 1);
+
+    setWindowTitle("Presenter Console");
+    resize(1200, 800);
+
+    // defaultState = saveState(); // Removed
+}
+
+void MainWindow::buildSearchPanel()
+{
+    // 0. Search
+    searchBox = new QLineEdit();
+    searchBox->setPlaceholderText("Search slides (Ctrl+F)");
+    searchBox->setClearButtonEnabled(true);
+    searchBox->installEventFilter(this); // Escape clears the query instead of quitting
+    connect(searchBox, &QLineEdit::textChanged, this, &MainWindow::runSearch);
+    connect(searchBox, &QLineEdit::returnPressed, this, [this](){
+        if (searchResults->count() > 0) jumpToPage(searchResults->item(0)->data(Qt::UserRole).toInt());
+    });
+
+    searchResults = new QListWidget();
+    searchResults->setIconSize(QSize(96, 54));
+    searchResults->setWordWrap(true);
+    searchResults->setMaximumHeight(240);
+    searchResults->hide(); // Only while there is a query
+    auto activate = [this](QListWidgetItem *item) {
+        if (item->data(Qt::UserRole).isValid()) jumpToPage(item->data(Qt::UserRole).toInt());
+    };
+    connect(searchResults, &QListWidget::itemActivated, this, activate);
+    connect(searchResults, &QListWidget::itemClicked, this, activate);
+
+    QLabel *searchTitle = new QLabel("Search");
+    searchTitle->setStyleSheet("font-weight: bold; background: #ddd; padding: 4px;");
+    leftColumn->addWidget(searchTitle);
+    leftColumn->addWidget(searchBox);
+    leftColumn->addWidget(searchResults);
+}
+
+void MainWindow::buildChaptersPanel()
+{
     // 1. Chapters
     QWidget *tocContainer = new QWidget();
     tocContainer->setStyleSheet("background-color: palette(base); color: palette(text);");
@@ -244,6 +489,16 @@ void MainWindow::setupUi()
     tocInnerLayout->addWidget(tocView);
     tocInnerLayout->addWidget(endNavBtn);
 
+    QLabel *tocTitle = new QLabel("Chapters");
+    tocTitle->setStyleSheet("font-weight: bold; background: #ddd; padding: 4px;");
+    leftColumn->addWidget(tocTitle);
+    leftColumn->addWidget(tocContainer, 1); // Expand TOC
+
+    syncTocWithPage(currentPage);
+}
+
+void MainWindow::buildMonitorPanel()
+{
     // 2. Monitor Manager
     QWidget *screenContainer = new QWidget();
     QVBoxLayout *scrLayout = new QVBoxLayout(screenContainer);
@@ -261,6 +516,7 @@ void MainWindow::setupUi()
         "Left/Back: Prev Slide<br>"
         "Home/End: First/Last<br>"
         "S: Switch Screens<br>"
+        "O: Slide Overview<br>"
         "L: Laser | Z: Zoom<br>"
         "P: Timer | Q: Quit"
     );
@@ -272,76 +528,24 @@ void MainWindow::setupUi()
     scrLayout->addWidget(helpLabel);
     scrLayout->addStretch();
 
-    // Assemble Left Column
-    // Add titles? Previously docks had titles.
-    // "Chapters", "Monitor Manager".
-    QLabel *tocTitle = new QLabel("Chapters");
-    tocTitle->setStyleSheet("font-weight: bold; background: #ddd; padding: 4px;");
     QLabel *screenTitle = new QLabel("Monitor Manager");
     screenTitle->setStyleSheet("font-weight: bold; background: #ddd; padding: 4px;");
+    leftColumn->addWidget(screenTitle);
+    leftColumn->addWidget(screenContainer, 0); // Fixed size for screens?
 
-    leftLayout->addWidget(tocTitle);
-    leftLayout->addWidget(tocContainer, 1); // Expand TOC
-    leftLayout->addWidget(screenTitle);
-    leftLayout->addWidget(screenContainer, 0); // Fixed size for screens?
-
-    // --- MIDDLE COLUMN (50%) ---
-    // Contains: Current Slide (Top), Notes (Bottom)
-
-    // 1. Check currentSlideView
-    QLabel *currentSlideTitle = new QLabel("Current Slide");
-    currentSlideTitle->setStyleSheet("font-weight: bold; padding: 5px;");
-    currentSlideTitle->setAlignment(Qt::AlignCenter);
-
-    currentSlideView = new QLabel("Current Slide");
-    currentSlideView->setAlignment(Qt::AlignCenter);
-    currentSlideView->setStyleSheet("background: #dddddd; border: 1px solid #999;");
-    currentSlideView->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
-    currentSlideView->setMinimumSize(50, 50);
-    currentSlideView->installEventFilter(this);
-
-    // 2. Notes
-    // Previously in notesDock
-    QLabel *notesTitle = new QLabel("Notes"); // Was dock title
-    notesTitle->setStyleSheet("font-weight: bold; background: #ddd; padding: 4px;");
-
-    notesView = new QTextEdit();
-    notesView->setPlaceholderText("Notes for this slide...");
-    // notesView->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored); // Maybe preferred now?
-
-    notesImageView = new QLabel("Notes View");
-    notesImageView->setAlignment(Qt::AlignCenter);
-    notesImageView->setStyleSheet("background: white; border: 1px solid #ccc;");
-    notesImageView->hide();
-
-    middleLayout->addWidget(currentSlideTitle);
-    middleLayout->addWidget(currentSlideView, 2); // Slide takes more space
-    middleLayout->addWidget(notesTitle);
-
-    // Notes Container (Stacking text/image)
-    QStackedLayout *notesStack = new QStackedLayout();
-    notesStack->addWidget(notesView);
-    notesStack->addWidget(notesImageView);
-    QWidget *notesWidget = new QWidget();
-    notesWidget->setLayout(notesStack);
-
-    middleLayout->addWidget(notesWidget, 1); // Notes take less space than slide
-
-
-    // --- RIGHT COLUMN (25%) ---
-    // Contains: Next Slide (Top), Control Center (Bottom)
-
-    // 1. Next Slide
-    QLabel *nextSlideTitle = new QLabel("Next Slide");
-    nextSlideTitle->setStyleSheet("font-weight: bold; padding: 5px;");
-    nextSlideTitle->setAlignment(Qt::AlignCenter);
+    updateScreenControls();
+    screenSelector->setAudienceScreen(QGuiApplication::screens().indexOf(presentationDisplay->screen()));
 
-    nextSlideView = new QLabel("Next Slide");
-    nextSlideView->setAlignment(Qt::AlignCenter);
-    nextSlideView->setStyleSheet("background: #eeeeee; border: 1px dashed #aaa;");
-    nextSlideView->setMinimumHeight(150);
-    nextSlideView->setSizePolicy(QSizePolicy::Ignored, QSizePolicy::Ignored);
+    // Connect to signal for future changes
+    connect(qApp, &QGuiApplication::screenAdded, this, &MainWindow::onScreenCountChanged);
+    connect(qApp, &QGuiApplication::screenRemoved, this, &MainWindow::onScreenCountChanged);
+    if (windowHandle()) {
+         connect(windowHandle(), &QWindow::screenChanged, this, &MainWindow::updateScreenControls);
+    }
+}
 
+void MainWindow::buildControlCenter()
+{
     // 2. Control Center
     QLabel *controlsTitle = new QLabel("Control Center");
     controlsTitle->setStyleSheet("font-weight: bold; background: #ddd; padding: 4px;");
@@ -367,7 +571,31 @@ void MainWindow::setupUi()
     connect(aspectRatioCheck, &QCheckBox::toggled, this, &MainWindow::toggleAspectRatioLock);
     controlsLeft->addWidget(consoleFullscreenCheck);
     controlsLeft->addWidget(audienceFullscreenCheck);
+    tiledRenderingCheck = new QCheckBox("Tiled Rendering");
+    tiledRenderingCheck->setToolTip("Render the audience slide as parallel tiles (video walls, 8K)");
+    connect(tiledRenderingCheck, &QCheckBox::toggled, this, [this](bool checked){ presentationDisplay->setTiledRendering(checked); });
+    gpuCompositingCheck = new QCheckBox("GPU Compositing");
+    gpuCompositingCheck->setToolTip("Draw the audience window through OpenGL; zoom and drawing stay smooth on 4K/8K slides.\n"
+                                    "Also works with software GL (LIBGL_ALWAYS_SOFTWARE=1).");
+    connect(gpuCompositingCheck, &QCheckBox::toggled, this, [this](bool checked){ presentationDisplay->setHardwareCompositing(checked); });
     controlsLeft->addWidget(aspectRatioCheck);
+    controlsLeft->addWidget(tiledRenderingCheck);
+    controlsLeft->addWidget(gpuCompositingCheck);
+
+    // Item data is the PresentationDisplay::TransitionStyle
+    transitionCombo = new QComboBox();
+    transitionCombo->addItem("No Transition", PresentationDisplay::NoTransition);
+    transitionCombo->addItem("Crossfade", PresentationDisplay::Crossfade);
+    transitionCombo->addItem("Push", PresentationDisplay::Push);
+    transitionCombo->addItem("Cover", PresentationDisplay::Cover);
+    transitionCombo->setToolTip("Animate page changes on the audience screen.\n"
+                                "Slides that are not rendered yet still change instantly.");
+    connect(transitionCombo, &QComboBox::currentIndexChanged, this, [this](int) {
+        presentationDisplay->setTransition(
+            PresentationDisplay::TransitionStyle(transitionCombo->currentData().toInt()),
+            presentationDisplay->transitionDuration());
+    });
+    controlsLeft->addWidget(transitionCombo);
     controlsLeft->addStretch();
 
     QVBoxLayout *controlsRight = new QVBoxLayout();
@@ -489,11 +717,15 @@ void MainWindow::setupUi()
     drawingThicknessSpin->setStyleSheet("QSpinBox { background: white; color: black; }");
     drawingLayout->addWidget(drawingThicknessSpin, 3, 1);
 
+    drawingSmoothCheck = new QCheckBox("Smooth strokes");
+    drawingLayout->addWidget(drawingSmoothCheck, 4, 0, 1, 2);
+
     // Initial signals
     connect(drawingCheckBox, &QCheckBox::clicked, this, &MainWindow::activateDrawing); // Checkbox toggle triggers logic
     connect(drawingColorCombo, &QComboBox::currentTextChanged, this, &MainWindow::updateDrawingSettings);
     connect(drawingStyleCombo, &QComboBox::currentTextChanged, this, &MainWindow::updateDrawingSettings);
     connect(drawingThicknessSpin, QOverload<int>::of(&QSpinBox::valueChanged), this, &MainWindow::updateDrawingSettings);
+    connect(drawingSmoothCheck, &QCheckBox::toggled, this, &MainWindow::updateDrawingSettings);
 
     // Add Drawing Group to Row 7
     featuresGrid->addWidget(drawingGroup, 7, 0, 1, 3);
@@ -627,47 +859,22 @@ void MainWindow::setupUi()
     centerLayout->addWidget(clockFrame);
     centerLayout->addWidget(closeFrame); // At the bottom
 
-    // Add to Right
-    rightLayout->addWidget(nextSlideTitle);
-    rightLayout->addWidget(nextSlideView, 2);
-    rightLayout->addWidget(controlsTitle);
-    rightLayout->addWidget(centerContainer, 1);
-
-
-    // --- COMPOSE MAIN ---
-    // Stretches: 1 (25%), 2 (50%), 1 (25%) -> Total 4 parts.
-    // 1/4 = 25%, 2/4 = 50%, 1/4 = 25%.
-
-    // Wrap layouts in widgets or add directly as layouts?
-    // QHBoxLayout::addLayout allows adding layouts.
-
-    mainLayout->addLayout(leftLayout, 1);
-    mainLayout->addLayout(middleLayout, 2);
-    mainLayout->addLayout(rightLayout, 1);
-
-    setWindowTitle("Presenter Console");
-    resize(1200, 800);
-
-    // defaultState = saveState(); // Removed
+    rightColumn->addWidget(controlsTitle);
+    rightColumn->addWidget(centerContainer, 1);
 }
 
-void MainWindow::detectScreens()
+void MainWindow::placeAudienceWindow()
 {
-    updateScreenControls();
-
-    // Connect to signal for future changes
-    connect(qApp, &QGuiApplication::screenAdded, this, &MainWindow::onScreenCountChanged);
-    connect(qApp, &QGuiApplication::screenRemoved, this, &MainWindow::onScreenCountChanged);
-
     // Initial positioning
     QList<QScreen*> screens = QGuiApplication::screens();
     if (screens.size() > 1) {
         // Move Presentation Window to the second screen by default
         onAudienceScreenSelected(1);
     } else {
-        // Single screen mode
+        // Single screen mode; the fullscreen checkbox does not exist yet
+        QSettings settings(".my_presenter_config.ini", QSettings::IniFormat);
         presentationDisplay->resize(800, 600);
-        if (audienceFullscreenCheck->isChecked()) {
+        if (settings.value("window/audienceFullscreen", false).toBool()) {
             presentationDisplay->showFullScreen();
         } else {
             presentationDisplay->show();
@@ -763,8 +970,8 @@ void MainWindow::onAudienceScreenSelected(int index)
                     // Let's just move it to center for safety, user can maximize
                     setGeometry(geo.x() + 50, geo.y() + 50, 1200, 800);
 
-                    // Update selector
-                    screenSelector->setConsoleScreen(targetConsoleIdx);
+                    // Update selector (built after the audience window is placed)
+                    if (screenSelector) screenSelector->setConsoleScreen(targetConsoleIdx);
                 }
             }
         }
@@ -782,7 +989,7 @@ void MainWindow::onAudienceScreenSelected(int index)
         presentationDisplay->showFullScreen();
 
         // Update selector state if visible
-        screenSelector->setAudienceScreen(index);
+        if (screenSelector) screenSelector->setAudienceScreen(index);
     }
 }
 
@@ -817,33 +1024,14 @@ void MainWindow::onConsoleScreenSelected(int index)
 
 void MainWindow::syncTocWithPage(int page)
 {
-    if (!bookmarkModel) return;
+    if (!bookmarkModel || !tocView) return;
+    if (tocStale) rebuildTocIndex();
 
+    // Last bookmark starting at or before 'page'
+    auto it = std::upper_bound(tocEntries.cbegin(), tocEntries.cend(), page,
+                               [](int p, const TocEntry &e) { return p < e.page; });
     QModelIndex bestMatch;
-    int bestPage = -1;
-
-    // Helper lambda for recursive search
-    std::function<void(const QModelIndex&)> search =
-        [&](const QModelIndex &parent) {
-        int rowCount = bookmarkModel->rowCount(parent);
-        for (int i = 0; i < rowCount; ++i) {
-            QModelIndex idx = bookmarkModel->index(i, 0, parent);
-            int pageNum = idx.data((int)QPdfBookmarkModel::Role::Page).toInt();
-
-            if (pageNum <= page) {
-                if (pageNum > bestPage) {
-                    bestPage = pageNum;
-                    bestMatch = idx;
-                }
-            }
-
-            if (bookmarkModel->hasChildren(idx)) {
-                search(idx);
-            }
-        }
-    };
-
-    search(QModelIndex());
+    if (it != tocEntries.cbegin()) bestMatch = (it - 1)->index;
 
     if (bestMatch.isValid()) {
         tocView->setCurrentIndex(bestMatch);
@@ -853,72 +1041,312 @@ void MainWindow::syncTocWithPage(int page)
     }
 }
 
+void MainWindow::watchBookmarks()
+{
+    // Any structural change invalidates the lookup; moves are tracked by the persistent indexes
+    auto stale = [this]() { tocStale = true; };
+    connect(bookmarkModel, &QAbstractItemModel::modelReset, this, stale);
+    connect(bookmarkModel, &QAbstractItemModel::rowsInserted, this, stale);
+    connect(bookmarkModel, &QAbstractItemModel::rowsRemoved, this, stale);
+    connect(bookmarkModel, &QAbstractItemModel::dataChanged, this, stale);
+}
+
+void MainWindow::rebuildTocIndex()
+{
+    ProfileScope scope("toc index");
+    tocStale = false;
+    tocEntries.clear();
+
+    // Tree order, iteratively: a parent comes before its children
+    QList<QModelIndex> stack{ QModelIndex() };
+    while (!stack.isEmpty()) {
+        const QModelIndex node = stack.takeLast();
+        const int rowCount = bookmarkModel->rowCount(node);
+        for (int row = rowCount - 1; row >= 0; --row) stack.append(bookmarkModel->index(row, 0, node));
+        if (!node.isValid()) continue;
+        const int page = node.data(int(QPdfBookmarkModel::Role::Page)).toInt();
+        if (page >= 0) tocEntries.append(TocEntry{ page, node });
+    }
+
+    // Several bookmarks on one page: the first in tree order stands for it
+    std::stable_sort(tocEntries.begin(), tocEntries.end(),
+                     [](const TocEntry &a, const TocEntry &b) { return a.page < b.page; });
+    auto last = std::unique(tocEntries.begin(), tocEntries.end(),
+                            [](const TocEntry &a, const TocEntry &b) { return a.page == b.page; });
+    tocEntries.erase(last, tocEntries.end());
+}
+
 void MainWindow::loadPdf(const QString &filePath)
 {
+    loadStart = RenderProfiler::now();
+    loadingFile = filePath;
     currentPage = 0;
-    pdf->load(filePath);
+    // Bookmarks and text of the previous deck must not land on this one
+    documentLoader->cancel();
+    if (presentationDisplay) presentationDisplay->setPackage(nullptr); // Until the new deck is known to match
+    packageKeyPending = false;
+    prefetcher->reset();
+    annotations->save();
+    annotations->open(AnnotationStore::sidecarPath(filePath));
+    // The previous deck's bookmarks and search index go away now; the new ones follow the first slide
+    pdf->close();
+    searchIndex.clear();
+    runSearch();
+    renderer->openDocument(filePath);
 
     QFileInfo fi(filePath);
+    showLoadStatus("Opening " + fi.fileName() + "...");
     if (presentationDisplay) {
         presentationDisplay->setWindowTitle("Audience Window - " + fi.fileName());
     }
 
-    // UI update handled by statusChanged signal
+    // UI update handled by the renderer's documentReady signal
 }
 
-void MainWindow::updateViews()
+bool MainWindow::openSlidePackage(const QString &path)
 {
-    if (pdf->status() != QPdfDocument::Status::Ready) return;
+    if (presentationDisplay) presentationDisplay->setPackage(nullptr);
+    if (!slidePackage.open(path)) return false;
+    // Attached in onDocumentReady() once the deck is known to match
+    qInfo("Playing from %s (%d pages at %dx%d)", qPrintable(QFileInfo(path).fileName()), slidePackage.pageCount(),
+          slidePackage.box().width(), slidePackage.box().height());
+    return true;
+}
 
-    // 0. Render Logic (first)
-    QImage audienceImg, notesImg;
-    {
-        // Calculate target size for the Current Slide preview
-        QSize targetSize = currentSlideView->size() * currentSlideView->devicePixelRatio();
-        if (targetSize.isEmpty()) {
-             targetSize = QSize(400, 300) * currentSlideView->devicePixelRatio(); // Fallback
+void MainWindow::onDocumentReady()
+{
+    // Only the deck the package was compiled from plays from it. Until its content
+    // key is known, slides render live: hashing the file must not delay the first one.
+    if (slidePackage.isOpen()) {
+        const quint64 check = ++packageCheck;
+        packageKeyPending = true;
+        const QString filePath = loadingFile;
+        if (!slidePackage.couldMatch(filePath, renderer->pageCount())) {
+            onPackageKey(check, QByteArray());
+        } else if (!renderer->contentKey().isEmpty()) {
+            onPackageKey(check, renderer->contentKey());
+        } else if (!renderer->hasDiskCache()) {
+            packageHashPool.start([this, check, filePath]() {
+                const QByteArray key = RasterDiskCache::contentKey(filePath);
+                QMetaObject::invokeMethod(this, [this, check, key]() { onPackageKey(check, key); },
+                                          Qt::QueuedConnection);
+            });
         }
+        // Otherwise the renderer is hashing the deck and reports it through contentKeyReady()
+    }
+    showLoadStatus(loadingFile.isEmpty() ? QString() : "Rendering first slide...");
+    updateViews();
+    presentationDisplay->refreshSlide();
+}
+
+void MainWindow::onPackageKey(quint64 check, const QByteArray &contentKey)
+{
+    if (check != packageCheck || !packageKeyPending) return; // Another deck was opened meanwhile
+    packageKeyPending = false;
+    // An edited deck may keep size and page count, and must never play stale slides
+    if (contentKey.isEmpty() || contentKey != slidePackage.contentKey()) {
+        qWarning("Slide package does not match the open deck; rendering live");
+        return;
+    }
+    presentationDisplay->setPackage(&slidePackage);
+}
+
+void MainWindow::onLoadProgress(int pagesDone, int pageCount)
+{
+    // Only worth showing for decks where the geometry pass takes a while
+    if (pageCount > 256) showLoadStatus(QString("Reading %1 pages...").arg(pageCount), pagesDone, pageCount);
+}
 
-        QSizeF pageSize = pdf->pagePointSize(currentPage);
+void MainWindow::onDocumentLoaded(QPdfDocument *document, QPdfBookmarkModel *bookmarks)
+{
+    showLoadStatus(QString());
+
+    // Until the chapters panel exists, it simply picks up the new model when built
+    QItemSelectionModel *oldSelection = tocView ? tocView->selectionModel() : nullptr;
+    QPdfBookmarkModel *oldBookmarks = bookmarkModel;
+    QPdfDocument *oldDocument = pdf;
+
+    document->setParent(this);
+    bookmarks->setParent(this);
+    pdf = document;
+    bookmarkModel = bookmarks;
+    tocEntries.clear();
+    tocStale = true;
+    watchBookmarks();
+    if (tocView) tocView->setModel(bookmarkModel);
+    delete oldSelection;
+    delete oldBookmarks;
+    delete oldDocument;
 
-        QSize renderSize(100, 100); // Default safe size
-        if (!pageSize.isEmpty()) {
-            if (useSplitView) {
-                // In split view, the slide is the left half.
-                QSizeF slideSize(pageSize.width() / 2.0, pageSize.height());
+    syncTocWithPage(currentPage);
+    updateSearchHighlights();
+}
 
-                // Scale factor to fit the half-slide into targetSize
-                QSize scaledHalf = slideSize.scaled(targetSize, Qt::KeepAspectRatio).toSize();
-                qreal scale = (slideSize.width() > 0) ? ((qreal)scaledHalf.width() / slideSize.width()) : 1.0;
+void MainWindow::showLoadStatus(const QString &message, int value, int maximum)
+{
+    // An empty message hides the indicator; maximum 0 makes it a busy indicator
+    if (message.isEmpty()) {
+        statusBar()->clearMessage();
+        statusBar()->hide();
+        return;
+    }
+    loadProgressBar->setRange(0, maximum);
+    loadProgressBar->setValue(value);
+    statusBar()->showMessage(message);
+    statusBar()->show();
+}
 
-                renderSize = QSize(pageSize.width() * scale, pageSize.height() * scale);
-            } else {
-                renderSize = pageSize.scaled(targetSize, Qt::KeepAspectRatio).toSize();
-            }
+void MainWindow::onIndexProgress(int pagesDone, int pageCount)
+{
+    // Small decks are indexed before anyone could read the message
+    if (pageCount > 64) showLoadStatus("Indexing text for search...", pagesDone, pageCount);
+}
+
+void MainWindow::onSearchIndexed(const SearchIndex &index)
+{
+    showLoadStatus(QString());
+    searchIndex = index;
+    // Typed while the deck was still being indexed
+    if (searchBox && !searchBox->text().isEmpty()) runSearch();
+}
+
+void MainWindow::runSearch()
+{
+    if (!searchResults) return;
+    for (auto it = searchTickets.constBegin(); it != searchTickets.constEnd(); ++it) renderer->cancel(it.key());
+    searchTickets.clear();
+    searchResults->clear();
+
+    const QString query = searchBox->text();
+    if (query.trimmed().isEmpty()) {
+        searchResults->hide();
+        updateSearchHighlights();
+        return;
+    }
+
+    QList<SearchIndex::Hit> hits;
+    {
+        ProfileScope scope("search");
+        hits = searchIndex.search(query);
+    }
+    for (const SearchIndex::Hit &hit : hits) {
+        QListWidgetItem *item = new QListWidgetItem(QString("Slide %1\n%2").arg(hit.page + 1).arg(hit.snippet), searchResults);
+        item->setData(Qt::UserRole, hit.page);
+
+        // Thumbnails come from the shared cache, or are rendered behind the slides
+        RenderRequest request = thumbnailRequestForPage(hit.page);
+        QImage cached = renderer->cachedImage(request);
+        if (!cached.isNull()) {
+            item->setIcon(QPixmap::fromImage(cached));
+        } else if (quint64 ticket = renderer->requestRender(request, SlideRenderer::Priority::Prefetch)) {
+            searchTickets.insert(ticket, hit.page);
         }
+    }
+    if (hits.isEmpty()) {
+        QListWidgetItem *item = new QListWidgetItem(searchIndex.isEmpty() ? "Still indexing..." : "No matches", searchResults);
+        item->setFlags(Qt::NoItemFlags);
+    }
+    searchResults->show();
+    updateSearchHighlights();
+}
 
-        // Ensure valid render size
-        if (renderSize.isEmpty()) renderSize = QSize(100, 100);
+void MainWindow::showSearchThumbnail(int page, const QImage &image)
+{
+    for (int row = 0; row < searchResults->count(); ++row) {
+        QListWidgetItem *item = searchResults->item(row);
+        if (item->data(Qt::UserRole).toInt() == page) {
+            item->setIcon(QPixmap::fromImage(image));
+            return;
+        }
+    }
+}
 
-        QImage currentFull = pdf->render(currentPage, renderSize);
+void MainWindow::updateSearchHighlights()
+{
+    // Outlines the query's words on the audience slide; the boxes were measured while indexing
+    const QString query = searchBox ? searchBox->text() : QString();
+    const QList<QRectF> rects = query.trimmed().isEmpty() ? QList<QRectF>()
+                                                           : searchIndex.matchesOnPage(currentPage, query);
+    presentationDisplay->setHighlights(currentPage, rects);
+}
 
-        if (useSplitView) {
-            int w = currentFull.width() / 2;
-            int h = currentFull.height();
-            if (w > 0 && h > 0) {
-                audienceImg = currentFull.copy(0, 0, w, h);
-                notesImg = currentFull.copy(w, 0, w, h);
-            }
+void MainWindow::toggleSlideSorter()
+{
+    if (slideSorter && consoleStack->currentWidget() == slideSorter) {
+        closeSlideSorter();
+        return;
+    }
+    if (!renderer->isReady()) return;
+
+    if (!slideSorter) {
+        ProfileScope scope("slide sorter");
+        slideSorter = new SlideSorter(renderer);
+        connect(slideSorter, &SlideSorter::pageActivated, this, [this](int page){
+            closeSlideSorter();
+            jumpToPage(page);
+        });
+        connect(slideSorter, &SlideSorter::closeRequested, this, &MainWindow::closeSlideSorter);
+        consoleStack->addWidget(slideSorter);
+    }
+    slideSorter->setSplitMode(useSplitView);
+    consoleStack->setCurrentWidget(slideSorter);
+    slideSorter->showPage(currentPage);
+    activateWindow();
+    slideSorter->setFocus();
+}
+
+void MainWindow::closeSlideSorter()
+{
+    consoleStack->setCurrentIndex(0);
+    currentSlideView->setFocus();
+}
+
+void MainWindow::focusSearch()
+{
+    if (!searchBox) return;
+    if (slideSorter) closeSlideSorter();
+    activateWindow();
+    searchBox->setFocus();
+    searchBox->selectAll();
+}
+
+void MainWindow::updateViews()
+{
+    if (!renderer->isReady()) return;
+    ProfileScope scope("updateViews");
+    settling = true;
+    audienceReady = false;
+    settleStart = RenderProfiler::now();
+
+    // 0. Request console renders; results arrive in onSlideRendered()
+    {
+        RenderRequest request = consoleRequestForPage(currentPage);
+
+        renderer->cancel(currentTicket);
+        currentTicket = 0;
+        QImage cached = renderer->cachedImage(request);
+        if (!cached.isNull()) {
+            showCurrentSlide(cached);
         } else {
-            audienceImg = currentFull;
+            currentTicket = renderer->requestRender(request);
         }
     }
 
     // 1. Update Notes (Mockup)
+    renderer->cancel(notesTicket);
+    notesTicket = 0;
     if (useSplitView) {
         notesView->hide();
         notesImageView->show();
-        notesImageView->setPixmap(QPixmap::fromImage(notesImg).scaled(notesImageView->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+
+        // The notes are the right half; rasterize just that half at the pane's size
+        RenderRequest request = notesRequestForPage(currentPage);
+        QImage cached = renderer->cachedImage(request);
+        if (!cached.isNull()) {
+            showNotesPage(cached);
+        } else {
+            notesTicket = renderer->requestRender(request);
+        }
     } else {
         notesImageView->hide();
         notesView->show();
@@ -928,23 +1356,23 @@ void MainWindow::updateViews()
     // 2. Update Audience Display (Metadata only)
     presentationDisplay->setSplitMode(useSplitView);
     presentationDisplay->setPage(currentPage);
-
-    // 3. Update Console View
-
-    currentSlideView->setPixmap(QPixmap::fromImage(audienceImg).scaled(currentSlideView->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    updateSearchHighlights();
+    // Same page and mode as before: the audience already shows its final raster
+    if (!presentationDisplay->isRefreshPending() && presentationDisplay->slideQuality() == PresentationDisplay::FullQuality) {
+        audienceReady = true;
+    }
 
     // 3. Render Next Slide Preview
-    if (currentPage + 1 < pdf->pageCount()) {
-        QSize nextRenderSize = pdf->pagePointSize(currentPage + 1).toSize();
-        QImage nextFull = pdf->render(currentPage + 1, nextRenderSize);
-        QImage nextPreview;
-
-        if (useSplitView) {
-            nextPreview = nextFull.copy(0, 0, nextFull.width() / 2, nextFull.height());
+    renderer->cancel(nextTicket);
+    nextTicket = 0;
+    if (currentPage + 1 < renderer->pageCount()) {
+        RenderRequest request = previewRequestForPage(currentPage + 1);
+        QImage cached = renderer->cachedImage(request);
+        if (!cached.isNull()) {
+            showNextSlide(cached);
         } else {
-            nextPreview = nextFull;
+            nextTicket = renderer->requestRender(request);
         }
-        nextSlideView->setPixmap(QPixmap::fromImage(nextPreview).scaled(nextSlideView->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
     } else {
         nextSlideView->setText("End of Presentation");
         nextSlideView->clear();
@@ -953,14 +1381,147 @@ void MainWindow::updateViews()
     notesView->setText(QString("Notes for Slide %1").arg(currentPage + 1));
 
     syncTocWithPage(currentPage);
+
+    // 5. Warm the cache around the new position; runs behind the renders above
+    prefetcher->schedule(currentPage);
+
+    checkViewsSettled();
+}
+
+void MainWindow::checkViewsSettled()
+{
+    if (!settling || !audienceReady || currentTicket || notesTicket || nextTicket) return;
+    settling = false;
+    RenderProfiler::record("views settled", settleStart, RenderProfiler::now() - settleStart);
+    emit viewsSettled(currentPage);
+}
+
+RenderRequest MainWindow::consoleRequestForPage(int page) const
+{
+    // Calculate target size for the Current Slide preview
+    QSize targetSize = currentSlideView->size() * currentSlideView->devicePixelRatio();
+    if (targetSize.isEmpty()) {
+         targetSize = QSize(400, 300) * currentSlideView->devicePixelRatio(); // Fallback
+    }
+
+    QSizeF pageSize = renderer->pagePointSize(page);
+
+    // In split view, the slide is the left half of the page
+    QRectF crop = useSplitView ? QRectF(0, 0, 0.5, 1) : QRectF(0, 0, 1, 1);
+    RenderRequest request = RenderRequest::fitted(page, pageSize, targetSize, crop, currentSlideView->devicePixelRatio());
+
+    // Ensure valid render size
+    if (!request.isValid()) {
+        request.page = page;
+        request.pageSize = QSize(100, 100); // Default safe size
+        request.clip = QRect();
+    }
+    return request;
+}
+
+RenderRequest MainWindow::notesRequestForPage(int page) const
+{
+    if (!useSplitView) return RenderRequest();
+
+    QSize targetSize = notesImageView->size() * notesImageView->devicePixelRatio();
+    if (targetSize.isEmpty()) {
+        targetSize = QSize(400, 300) * notesImageView->devicePixelRatio(); // Fallback
+    }
+    return RenderRequest::fitted(page, renderer->pagePointSize(page), targetSize, QRectF(0.5, 0, 0.5, 1),
+                                 notesImageView->devicePixelRatio());
+}
+
+RenderRequest MainWindow::previewRequestForPage(int page) const
+{
+    if (page < 0 || page >= renderer->pageCount()) return RenderRequest();
+
+    // Render at the preview's own size so small previews stay cheap and HiDPI ones sharp
+    QSize targetSize = nextSlideView->size() * nextSlideView->devicePixelRatio();
+    if (targetSize.isEmpty()) {
+        targetSize = QSize(300, 200) * nextSlideView->devicePixelRatio(); // Fallback
+    }
+    QRectF crop = useSplitView ? QRectF(0, 0, 0.5, 1) : QRectF(0, 0, 1, 1);
+    return RenderRequest::fitted(page, renderer->pagePointSize(page), targetSize, crop,
+                                 nextSlideView->devicePixelRatio());
+}
+
+RenderRequest MainWindow::thumbnailRequestForPage(int page) const
+{
+    if (page < 0 || page >= renderer->pageCount()) return RenderRequest();
+    const qreal dpr = searchResults->devicePixelRatio();
+    QRectF crop = useSplitView ? QRectF(0, 0, 0.5, 1) : QRectF(0, 0, 1, 1);
+    return RenderRequest::fitted(page, renderer->pagePointSize(page), searchResults->iconSize() * dpr, crop, dpr);
+}
+
+void MainWindow::onSlideRendered(quint64 ticket, const RenderRequest &, const QImage &image)
+{
+    // A failed render (null image) still settles its view, which keeps what it showed
+    if (ticket == currentTicket) {
+        currentTicket = 0;
+        if (!image.isNull()) showCurrentSlide(image);
+    } else if (ticket == notesTicket) {
+        notesTicket = 0;
+        if (!image.isNull()) showNotesPage(image);
+    } else if (ticket == nextTicket) {
+        nextTicket = 0;
+        if (!image.isNull()) showNextSlide(image);
+    } else if (searchTickets.contains(ticket)) {
+        const int page = searchTickets.take(ticket);
+        if (!image.isNull()) showSearchThumbnail(page, image);
+    }
+    checkViewsSettled();
+}
+
+void MainWindow::onAudienceQualityChanged(PresentationDisplay::SlideQuality quality)
+{
+    switch (quality) {
+    case PresentationDisplay::NoSlide:
+        audienceQualityLabel->setText("Audience: no slide");
+        audienceQualityLabel->setStyleSheet("color: #555; font-size: 10px;");
+        break;
+    case PresentationDisplay::Placeholder:
+        audienceQualityLabel->setText("Audience: preview (refining...)");
+        audienceQualityLabel->setStyleSheet("color: #c60; font-size: 10px;");
+        break;
+    case PresentationDisplay::FullQuality:
+        audienceQualityLabel->setText(presentationDisplay->playsFromPackage() ? "Audience: full quality (package)"
+                                                                              : "Audience: full quality");
+        audienceQualityLabel->setStyleSheet("color: #080; font-size: 10px;");
+        break;
+    }
+}
+
+// Console rasters are rendered at widget size x DPR, so they are shown 1:1 without rescaling
+void MainWindow::showCurrentSlide(const QImage &image)
+{
+    ProfileScope scope("pixmap upload");
+    currentSlideView->setPixmap(QPixmap::fromImage(image));
+}
+
+void MainWindow::showNotesPage(const QImage &image)
+{
+    ProfileScope scope("pixmap upload");
+    notesImageView->setPixmap(QPixmap::fromImage(image));
+}
+
+void MainWindow::showNextSlide(const QImage &image)
+{
+    ProfileScope scope("pixmap upload");
+    nextSlideView->setPixmap(QPixmap::fromImage(image));
 }
 
 void MainWindow::onBookmarkActivated(const QModelIndex &index)
 {
     if (!index.isValid()) return;
-    int page = index.data((int)QPdfBookmarkModel::Role::Page).toInt();
-    if (page >= 0 && page < pdf->pageCount()) {
+    jumpToPage(index.data((int)QPdfBookmarkModel::Role::Page).toInt());
+}
+
+void MainWindow::jumpToPage(int page)
+{
+    if (page >= 0 && page < renderer->pageCount()) {
+        prefetcher->noteJump(currentPage, page);
         currentPage = page;
+        RenderProfiler::beginPageTurn(currentPage);
         updateViews();
     }
 }
@@ -978,6 +1539,52 @@ void MainWindow::updateTimers()
                               .arg(m, 2, 10, QChar('0'))
                               .arg(s, 2, 10, QChar('0')));
     }
+    if (profilerHud->isVisible()) updateProfilerHud();
+}
+
+void MainWindow::toggleProfilerHud()
+{
+    profilerHud->setVisible(!profilerHud->isVisible());
+    if (profilerHud->isVisible()) updateProfilerHud();
+}
+
+void MainWindow::updateProfilerHud()
+{
+    auto line = [](const char *label, const char *name) {
+        RenderProfiler::Percentiles p = RenderProfiler::percentiles(name);
+        return QString("%1 p50 %2 ms  p99 %3 ms  (n=%4)").arg(label)
+            .arg(p.p50Ms, 0, 'f', 1).arg(p.p99Ms, 0, 'f', 1).arg(p.samples);
+    };
+    auto transitionLine = [this]() {
+        PresentationDisplay::TransitionStats t = presentationDisplay->transitionStats();
+        return QString("Last transition: %1 frames, %2 dropped, worst %3 ms (budget %4 ms)")
+            .arg(t.frames).arg(t.droppedFrames)
+            .arg(t.worstFrameMs, 0, 'f', 1).arg(t.frameBudgetMs, 0, 'f', 1);
+    };
+    auto refreshLine = [this]() {
+        PresentationDisplay::RenderStats r = presentationDisplay->renderStats();
+        return QString("Audience: %1 invalidations, %2 renders").arg(r.invalidations).arg(r.renders);
+    };
+    profilerHud->setText(QStringList{
+        line("Open deck ", "first slide"),
+        line("Page turn ", "page turn"),
+        line("All views ", "views settled"),
+        line("PDF render", "pdf render"),
+        line("Paint     ", "audience paint"),
+        line("Transition", "transition frame"),
+        line("Search    ", "search"),
+        transitionLine(),
+        refreshLine(),
+    }.join('\n'));
+}
+
+void MainWindow::exportTrace()
+{
+    QString fileName = QFileDialog::getSaveFileName(this, "Export Render Trace", "render-trace.json", "Trace Files (*.json)");
+    if (fileName.isEmpty()) return;
+    if (!RenderProfiler::exportChromeTrace(fileName)) {
+        QMessageBox::warning(this, "Export Failed", "Could not write " + fileName);
+    }
 }
 
 void MainWindow::toggleSplitView()
@@ -1025,6 +1632,19 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
         }
     }
 
+    if (obj == searchBox && (event->type() == QEvent::ShortcutOverride || event->type() == QEvent::KeyPress)) {
+        // Escape is the quit hotkey everywhere else; here it ends the search
+        QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
+        if (keyEvent->key() == Qt::Key_Escape) {
+            if (event->type() == QEvent::KeyPress) {
+                searchBox->clear();
+                currentSlideView->setFocus();
+            }
+            event->accept();
+            return true;
+        }
+    }
+
     if (obj == presentationDisplay && event->type() == QEvent::KeyPress) {
         QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
         int key = keyEvent->key();
@@ -1041,6 +1661,7 @@ bool MainWindow::eventFilter(QObject *obj, QEvent *event)
 
         // Screen Management
         case Qt::Key_S: switchScreens(); return true;
+        case Qt::Key_O: toggleSlideSorter(); return true;
 
         // Navigation
         case Qt::Key_Right: 
@@ -1084,7 +1705,15 @@ void MainWindow::resizeEvent(QResizeEvent *event)
 
 void MainWindow::closeEvent(QCloseEvent *event)
 {
-    saveSettings();
+    // Report cache effectiveness so the budget can be sized for large decks
+    SlideCache::Stats stats = renderer->cacheStats();
+    qInfo("Slide cache: %llu hits, %llu misses, %llu evictions, %d entries, %lld/%lld MB",
+          stats.hits, stats.misses, stats.evictions, stats.entries,
+          stats.usedBytes / (1024 * 1024), stats.budgetBytes / (1024 * 1024));
+
+    // Closed before the control center existed: there is nothing new to save
+    if (startupStages.isEmpty()) saveSettings();
+    annotations->save();
     presentationDisplay->close();
     QMainWindow::closeEvent(event);
 }
@@ -1206,6 +1835,8 @@ void MainWindow::updateDrawingSettings()
 
     // Thickness
     presentationDisplay->setDrawingThickness(drawingThicknessSpin->value());
+
+    presentationDisplay->setDrawingSmoothing(drawingSmoothCheck->isChecked());
 }
 
 void MainWindow::resetCursor()
@@ -1284,9 +1915,6 @@ void MainWindow::loadSettings()
 {
     QSettings settings(".my_presenter_config.ini", QSettings::IniFormat);
 
-    restoreGeometry(settings.value("window/geometry").toByteArray());
-    // restoreState removed
-
     // Forced Normal Cursor on Startup (User Request)
     // We intentionally do NOT load "features/laser" or "features/zoom" checks here.
     // Ensure they are unchecked by default (which they are in constructor/UI init).
@@ -1338,6 +1966,7 @@ void MainWindow::loadSettings()
     if (settings.contains("features/drawingThickness")) {
         drawingThicknessSpin->setValue(settings.value("features/drawingThickness").toInt());
     }
+    drawingSmoothCheck->setChecked(settings.value("features/drawingSmooth", false).toBool());
 
     // Load Fonts (Family/Style)
     if (settings.contains("font/clockFont")) {
@@ -1384,6 +2013,43 @@ void MainWindow::loadSettings()
         bool locked = settings.value("window/aspectRatioLock").toBool();
         aspectRatioCheck->setChecked(locked);
     }
+
+    if (settings.contains("render/tiled")) {
+        tiledRenderingCheck->setChecked(settings.value("render/tiled").toBool());
+    }
+    gpuCompositingCheck->setChecked(settings.value("render/gpuCompositing", false).toBool());
+    int transitionIndex = transitionCombo->findData(settings.value("render/transition", PresentationDisplay::NoTransition).toInt());
+    transitionCombo->setCurrentIndex(qMax(0, transitionIndex));
+}
+
+void MainWindow::loadEarlySettings()
+{
+    // Everything that shapes the first frame; the control center later shows the same values
+    QSettings settings(".my_presenter_config.ini", QSettings::IniFormat);
+
+    restoreGeometry(settings.value("window/geometry").toByteArray());
+    // restoreState removed
+
+    presentationDisplay->setTiledRendering(settings.value("render/tiled", false).toBool());
+    presentationDisplay->setHardwareCompositing(settings.value("render/gpuCompositing", false).toBool());
+    presentationDisplay->setTransition(
+        PresentationDisplay::TransitionStyle(settings.value("render/transition", PresentationDisplay::NoTransition).toInt()),
+        settings.value("render/transitionMs", presentationDisplay->transitionDuration()).toInt());
+
+    // Prefetch window around the current page
+    prefetcher->setWindow(settings.value("render/prefetchAhead", prefetcher->pagesAhead()).toInt(),
+                          settings.value("render/prefetchBehind", prefetcher->pagesBehind()).toInt());
+
+    // Raster cache budget in MB (shared by console and audience views)
+    if (settings.contains("render/cacheBudgetMB")) {
+        int mb = settings.value("render/cacheBudgetMB").toInt();
+        if (mb > 0) renderer->setCacheBudget(qint64(mb) * 1024 * 1024);
+    }
+
+    // Rasters kept on disk across runs, so a rehearsed deck reopens without rendering; 0 MB turns it off
+    const qint64 diskMb = settings.value("render/diskCacheMB", 1024).toLongLong();
+    renderer->setDiskCache(settings.value("render/diskCacheDir", RasterDiskCache::defaultDirectory()).toString(),
+                           diskMb * 1024 * 1024);
 }
 
 void MainWindow::saveSettings()
@@ -1406,6 +2072,7 @@ void MainWindow::saveSettings()
     settings.setValue("features/drawingColor", drawingColorCombo->currentText());
     settings.setValue("features/drawingStyle", drawingStyleCombo->currentText());
     settings.setValue("features/drawingThickness", drawingThicknessSpin->value());
+    settings.setValue("features/drawingSmooth", drawingSmoothCheck->isChecked());
 
     settings.setValue("font/clockSize", clockFontSlider->value());
     settings.setValue("font/timerSize", timerFontSlider->value());
@@ -1437,4 +2104,12 @@ void MainWindow::saveSettings()
     settings.setValue("window/consoleFullscreen", consoleFullscreenCheck->isChecked());
     settings.setValue("window/audienceFullscreen", audienceFullscreenCheck->isChecked());
     settings.setValue("window/aspectRatioLock", aspectRatioCheck->isChecked());
+
+    settings.setValue("render/tiled", tiledRenderingCheck->isChecked());
+    settings.setValue("render/gpuCompositing", gpuCompositingCheck->isChecked());
+    settings.setValue("render/transition", transitionCombo->currentData().toInt());
+    settings.setValue("render/transitionMs", presentationDisplay->transitionDuration());
+    settings.setValue("render/prefetchAhead", prefetcher->pagesAhead());
+    settings.setValue("render/prefetchBehind", prefetcher->pagesBehind());
+    settings.setValue("render/cacheBudgetMB", renderer->cacheStats().budgetBytes / (1024 * 1024));
 }
@@ -1,31 +1,73 @@
 #include "presentationdisplay.h"
+#include "renderprofiler.h"
+#include "audienceglsurface.h"
+#include "slidepackage.h"
+#include <QEasingCurve>
 #include <QPainterPath>
 #include <QPen>
 #include <QWindow>
 #include <QGuiApplication>
 #include <QScreen>
+#include <QSet>
+#include <QThread>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+// Edge length of a render tile in physical pixels
+const int kTileSize = 512;
+}
 
 PresentationDisplay::PresentationDisplay(QWidget *parent)
-    : QWidget(parent), pdf(nullptr), currentPage(0), splitView(false),
+    : QWidget(parent), renderer(nullptr), currentPage(0), splitView(false), pendingTicket(0), placeholderTicket(0), quality(NoSlide), finalSlidePage(-1), previousPageShown(false), tiled(false), refreshQueued(false), glSurface(nullptr), package(nullptr),
       laserActive(false), laserDiameter(60), laserOpacity(128), laserColor(Qt::red), zoomActive(false), zoomFactor(2.0f), zoomDiameter(250),
-      drawingActive(false), drawColor(Qt::red), drawThickness(5), drawStyle(Qt::SolidLine), isDrawing(false),
+      annotations(nullptr), drawingActive(false), drawColor(Qt::red), drawThickness(5), drawStyle(Qt::SolidLine), isDrawing(false),
+      transition(NoTransition), transitionMs(350), transitionPending(false), transitioning(false), transitionFrameDue(false), transitionDirection(1), lastFrameNs(0),
+      highlightPage(-1),
       lockedAspectRatio(false), isResizing(false)
 {
     setMouseTracking(true);
     setAttribute(Qt::WA_OpaquePaintEvent);
     setFocusPolicy(Qt::StrongFocus);
     laserCursor = createLaserCursor();
+
+    repaintTimer = new QTimer(this);
+    repaintTimer->setSingleShot(true);
+    repaintTimer->setTimerType(Qt::PreciseTimer);
+    connect(repaintTimer, &QTimer::timeout, this, &PresentationDisplay::flushRepaint);
+    sinceLastFlush.start();
+
+    frameTimer = new QTimer(this);
+    frameTimer->setSingleShot(true);
+    frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(frameTimer, &QTimer::timeout, this, [this]() {
+        transitionFrameDue = true;
+        updateSurface();
+    });
 }
 
-void PresentationDisplay::setDocument(QPdfDocument *doc)
+void PresentationDisplay::setRenderer(SlideRenderer *r)
 {
-    pdf = doc;
+    if (renderer) disconnect(renderer, nullptr, this, nullptr);
+    renderer = r;
+    pendingTicket = 0;
+    if (renderer) {
+        connect(renderer, &SlideRenderer::imageReady, this, &PresentationDisplay::onImageReady);
+    }
     refreshSlide();
 }
 
 void PresentationDisplay::setPage(int page)
 {
     if (currentPage != page) {
+        // Animate away from what the audience sees now, but only from a final raster
+        if (transition != NoTransition && quality == FullQuality && !cachedSlide.isNull() && isVisible()) {
+            if (transitioning) finishTransition();
+            transitionFrom = cachedSlide;
+            transitionFromRect = slideTargetRect();
+            transitionDirection = page > currentPage ? 1 : -1;
+            transitionPending = true;
+        }
         currentPage = page;
         refreshSlide();
     }
@@ -41,16 +83,127 @@ void PresentationDisplay::setSplitMode(bool split)
 
 void PresentationDisplay::refreshSlide()
 {
+    ++stats.invalidations;
+    if (refreshQueued) return;
+    refreshQueued = true;
+    QMetaObject::invokeMethod(this, &PresentationDisplay::flushRefresh, Qt::QueuedConnection);
+}
+
+void PresentationDisplay::flushRefresh()
+{
+    if (!refreshQueued) return;
+    refreshQueued = false;
+    ++stats.renders;
+    // Geometry or page changed under a running transition: jump to its end
+    if (transitioning) finishTransition();
+
     renderCurrentSlide();
-    renderCurrentSlide();
-    // Default: drawings persist. If we wanted to clear them on slide change:
-    // clearDrawings(); 
-    // For now, per user request, we might want persistent canvas or one per page. 
-    // Standard presentation behavior usually clears drawings reset on page change.
-    // Let's implement auto-clear for now to keep it clean.
-    strokes.clear();
-    currentStroke.clear();
-    update();
+    if (transitionPending) {
+        transitionPending = false;
+        // Only a cache hit can be animated; anything still rendering is a cut
+        if (quality == FullQuality) {
+            startTransition();
+        } else {
+            transitionFrom = QImage();
+            lastTransition = TransitionStats();
+        }
+    }
+    // Drawings belong to the page; re-place them for the new page or geometry
+    strokeInput.clear();
+    loadPageStrokes();
+    updateSurface();
+}
+
+void PresentationDisplay::setTransition(TransitionStyle style, int durationMs)
+{
+    transition = style;
+    transitionMs = qMax(1, durationMs);
+    if (transition == NoTransition && transitioning) finishTransition();
+}
+
+void PresentationDisplay::startTransition()
+{
+    transitioning = true;
+    transitionFrameDue = true;
+    lastTransition = TransitionStats();
+    lastTransition.frameBudgetMs = frameIntervalMs();
+    transitionClock.start();
+    lastFrameNs = 0;
+    updateSurface();
+}
+
+void PresentationDisplay::finishTransition()
+{
+    transitioning = false;
+    transitionFrom = QImage();
+    frameTimer->stop();
+    updateSurface();
+}
+
+void PresentationDisplay::recordTransitionFrame()
+{
+    const qint64 nowNs = transitionClock.nsecsElapsed();
+    if (lastTransition.frames > 0) {
+        const qint64 intervalNs = nowNs - lastFrameNs;
+        const qreal intervalMs = intervalNs / 1e6;
+        const qreal budget = lastTransition.frameBudgetMs;
+        lastTransition.worstFrameMs = qMax(lastTransition.worstFrameMs, intervalMs);
+        // Half a refresh of slack absorbs timer jitter
+        if (intervalMs > 1.5 * budget) lastTransition.droppedFrames += qRound(intervalMs / budget) - 1;
+        RenderProfiler::record("transition frame", RenderProfiler::now() - intervalNs, intervalNs);
+    }
+    ++lastTransition.frames;
+    lastFrameNs = nowNs;
+}
+
+void PresentationDisplay::paintTransition(QPainter &painter)
+{
+    const qreal progress = qMin(1.0, transitionClock.nsecsElapsed() / (transitionMs * 1e6));
+    const qreal t = QEasingCurve(QEasingCurve::InOutCubic).valueForProgress(progress);
+    const QRect to = slideTargetRect();
+    const int travel = width() * transitionDirection;
+
+    // Both rasters are already at window resolution; no filtering needed
+    painter.fillRect(rect(), Qt::black);
+    switch (transition) {
+    case Crossfade:
+        painter.drawImage(transitionFromRect, transitionFrom);
+        painter.setOpacity(t);
+        painter.drawImage(to, cachedSlide);
+        painter.setOpacity(1.0);
+        break;
+    case Push: {
+        const int shift = qRound(travel * t);
+        painter.drawImage(transitionFromRect.translated(-shift, 0), transitionFrom);
+        painter.drawImage(to.translated(travel - shift, 0), cachedSlide);
+        break;
+    }
+    case Cover:
+        painter.drawImage(transitionFromRect, transitionFrom);
+        painter.drawImage(to.translated(qRound(travel * (1.0 - t)), 0), cachedSlide);
+        break;
+    case NoTransition:
+        painter.drawImage(to, cachedSlide);
+        break;
+    }
+
+    // Lens, laser and stroke repaints show the current state too, but only the
+    // paced frames are counted and schedule the next one
+    if (!transitionFrameDue) {
+        if (progress >= 1.0) finishTransition();
+        return;
+    }
+    transitionFrameDue = false;
+    recordTransitionFrame();
+    if (progress >= 1.0) {
+        finishTransition();
+    } else if (!glSurface) {
+        // Aim the next frame at the next refresh boundary so timer drift does not accumulate.
+        // GL frames are paced by the vsync'ed buffer swap instead.
+        const qreal period = lastTransition.frameBudgetMs;
+        const qreal elapsed = transitionClock.nsecsElapsed() / 1e6;
+        frameTimer->start(qMax(1, int(period - std::fmod(elapsed, period))));
+    }
 }
 
 void PresentationDisplay::enableLaserPointer(bool active)
@@ -69,12 +222,13 @@ void PresentationDisplay::enableLaserPointer(bool active)
             unsetCursor();
         }
     }
-    update();
+    updateSurface();
 }
 
 void PresentationDisplay::enableZoom(bool active)
 {
     zoomActive = active;
+    if (active) requestZoomTiles();
     
     if (active) {
         // Zoom takes visual precedence
@@ -87,14 +241,18 @@ void PresentationDisplay::enableZoom(bool active)
             unsetCursor();
         }
     }
-    update();
+    updateSurface();
 }
 
 void PresentationDisplay::setZoomSettings(float factor, int diameter)
 {
+    if (!qFuzzyCompare(zoomFactor, factor)) clearZoomTiles();
     zoomFactor = factor;
     zoomDiameter = diameter;
-    if (zoomActive) update();
+    if (zoomActive) {
+        requestZoomTiles();
+        updateSurface();
+    }
 }
 
 void PresentationDisplay::setLaserSettings(int diameter, int opacity)
@@ -141,7 +299,7 @@ void PresentationDisplay::enableDrawing(bool active)
             unsetCursor();
         }
     }
-    update();
+    updateSurface();
 }
 
 void PresentationDisplay::setDrawingColor(const QColor &color)
@@ -161,11 +319,27 @@ void PresentationDisplay::setDrawingStyle(Qt::PenStyle style)
     drawStyle = style;
 }
 
+void PresentationDisplay::setDrawingSmoothing(bool enabled)
+{
+    strokeInput.setSmoothing(enabled);
+}
+
 void PresentationDisplay::clearDrawings()
 {
+    if (annotations) annotations->clearPage(currentPage);
     strokes.clear();
-    currentStroke.clear();
-    update();
+    strokeInput.clear();
+    clearStrokeLayer();
+    updateSurface();
+}
+
+void PresentationDisplay::setHighlights(int page, const QList<QRectF> &pageRects)
+{
+    if (pageRects.isEmpty()) page = -1;
+    if (page == highlightPage && pageRects == highlights) return;
+    highlightPage = page;
+    highlights = pageRects;
+    updateSurface();
 }
 
 QCursor PresentationDisplay::createPenCursor()
@@ -267,6 +441,8 @@ QCursor PresentationDisplay::createLaserCursor()
 
 void PresentationDisplay::resizeEvent(QResizeEvent *)
 {
+    if (glSurface) glSurface->setGeometry(rect());
+
     // If in Fullscreen mode, do NOT resize the window. 
     // The paintEvent handles centering and black bars.
     if (isFullScreen()) {
@@ -274,9 +450,9 @@ void PresentationDisplay::resizeEvent(QResizeEvent *)
         return;
     }
 
-    if (lockedAspectRatio && !isResizing && pdf && pdf->pageCount() > 0) {
+    if (lockedAspectRatio && !isResizing && renderer && renderer->pageCount() > 0) {
         
-        QSizeF pageSize = pdf->pagePointSize(currentPage);
+        QSizeF pageSize = renderer ? renderer->pagePointSize(currentPage) : QSizeF();
         if (!pageSize.isEmpty() && pageSize.height() > 0) {
             double aspect = pageSize.width() / pageSize.height();
             if (splitView) aspect /= 2.0;
@@ -314,6 +490,16 @@ void PresentationDisplay::resizeEvent(QResizeEvent *)
     refreshSlide();
 }
 
+bool PresentationDisplay::event(QEvent *event)
+{
+    // Moving to a screen with another scale factor needs a sharper or smaller raster
+#if QT_VERSION >= QT_VERSION_CHECK(6, 6, 0)
+    if (event->type() == QEvent::DevicePixelRatioChange) refreshSlide();
+#endif
+    if (event->type() == QEvent::ScreenChangeInternal) refreshSlide();
+    return QWidget::event(event);
+}
+
 void PresentationDisplay::setAspectRatioLock(bool locked)
 {
     lockedAspectRatio = locked;
@@ -325,23 +511,143 @@ void PresentationDisplay::setAspectRatioLock(bool locked)
 
 void PresentationDisplay::mouseMoveEvent(QMouseEvent *event)
 {
+    QPoint previousPos = mousePos;
     mousePos = event->pos();
     if (zoomActive) {
-        update();
+        requestZoomTiles();
+        // Only the area the lens left and the area it now covers change
+        scheduleRepaint(lensBounds(previousPos) | lensBounds(mousePos));
     }
     
-    if (drawingActive && isDrawing) {
-        currentStroke << event->pos();
-        update();
+    if (drawingActive && isDrawing && !strokeInput.isEmpty()) {
+        const QPointF previousEnd = strokeInput.points().last();
+        int from = strokeInput.addPoint(event->pos());
+        if (from >= 0) {
+            // Repaint just the changed tail of the stroke, padded by the pen width
+            QPolygonF changed(strokeInput.points().mid(from));
+            changed << previousEnd;
+            int pad = drawThickness / 2 + 2;
+            scheduleRepaint(changed.boundingRect().toAlignedRect().adjusted(-pad, -pad, pad, pad));
+        }
+    }
+}
+
+void PresentationDisplay::ensureStrokeLayer()
+{
+    const qreal dpr = devicePixelRatio();
+    const QSize pixelSize = size() * dpr;
+    if (strokeLayer.size() == pixelSize && qFuzzyCompare(strokeLayer.devicePixelRatio(), dpr)) return;
+
+    // Window size or scale changed: re-rasterize the committed strokes once
+    strokeLayer = QImage(pixelSize, QImage::Format_ARGB32_Premultiplied);
+    strokeLayer.setDevicePixelRatio(dpr);
+    strokeLayer.fill(Qt::transparent);
+    for (const Stroke &s : strokes) {
+        bakeStroke(s);
+    }
+}
+
+void PresentationDisplay::bakeStroke(const Stroke &stroke)
+{
+    if (strokeLayer.isNull()) return;
+    QPainter p(&strokeLayer);
+    p.setRenderHint(QPainter::Antialiasing);
+    p.setPen(stroke.pen);
+    p.drawPolyline(stroke.points);
+}
+
+void PresentationDisplay::clearStrokeLayer()
+{
+    strokeLayer = QImage();
+}
+
+void PresentationDisplay::setAnnotationStore(AnnotationStore *store)
+{
+    annotations = store;
+    loadPageStrokes();
+    updateSurface();
+}
+
+QRect PresentationDisplay::annotationRect() const
+{
+    // Where the (logical) slide sits in the window, whether or not its raster has arrived yet
+    QSize slideSize = requestForPage(currentPage).outputSize();
+    if (slideSize.isEmpty()) return QRect();
+    slideSize.scale(size(), Qt::KeepAspectRatio);
+
+    QRect area(QPoint(0, 0), slideSize);
+    area.moveCenter(rect().center());
+    return area;
+}
+
+void PresentationDisplay::loadPageStrokes()
+{
+    strokes.clear();
+    clearStrokeLayer();
+    const QRect area = annotationRect();
+    if (!annotations || area.isEmpty()) return;
+
+    const int count = annotations->strokeCount(currentPage);
+    strokes.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        const QPolygonF normalized = annotations->strokePoints(currentPage, i);
+        if (normalized.isEmpty()) continue;
+        const AnnotationPen pen = annotations->strokePen(currentPage, i);
+
+        Stroke s;
+        s.points.reserve(normalized.size());
+        for (const QPointF &p : normalized) {
+            s.points << QPointF(area.x() + p.x() * area.width(), area.y() + p.y() * area.height());
+        }
+        qreal width = qMax<qreal>(1.0, pen.width * area.width());
+        s.pen = QPen(QColor::fromRgba(pen.color), width, Qt::PenStyle(pen.style), Qt::RoundCap, Qt::RoundJoin);
+        qreal pad = width / 2.0 + 1;
+        s.bounds = s.points.boundingRect().adjusted(-pad, -pad, pad, pad);
+        strokes.append(s);
+    }
+}
+
+QRect PresentationDisplay::lensBounds(const QPoint &center) const
+{
+    // Lens circle plus its 2px outline
+    int r = zoomDiameter / 2 + 2;
+    return QRect(center.x() - r, center.y() - r, 2 * r + 1, 2 * r + 1);
+}
+
+void PresentationDisplay::scheduleRepaint(const QRect &area)
+{
+    dirtyRegion += area;
+    if (repaintTimer->isActive()) return;
+
+    // Mouse events arrive faster than the display refreshes; flush once per frame
+    int frameMs = qMax(1, qRound(frameIntervalMs()));
+    qint64 elapsed = sinceLastFlush.elapsed();
+    if (elapsed >= frameMs) {
+        flushRepaint();
+    } else {
+        repaintTimer->start(frameMs - int(elapsed));
     }
 }
 
+qreal PresentationDisplay::frameIntervalMs() const
+{
+    qreal hz = screen() ? screen()->refreshRate() : 60.0;
+    return 1000.0 / (hz > 0 ? hz : 60.0);
+}
+
+void PresentationDisplay::flushRepaint()
+{
+    if (dirtyRegion.isEmpty()) return;
+    updateSurface(dirtyRegion);
+    dirtyRegion = QRegion();
+    sinceLastFlush.restart();
+}
+
 void PresentationDisplay::mousePressEvent(QMouseEvent *event)
 {
     if (drawingActive && event->button() == Qt::LeftButton) {
         isDrawing = true;
-        currentStroke.clear();
-        currentStroke << event->pos();
+        strokeInput.begin(event->pos());
     }
 }
 
@@ -349,81 +655,533 @@ void PresentationDisplay::mouseReleaseEvent(QMouseEvent *event)
 {
     if (drawingActive && event->button() == Qt::LeftButton && isDrawing) {
         isDrawing = false;
-        if (!currentStroke.isEmpty()) {
+        if (!strokeInput.isEmpty()) {
+            qreal pad = drawThickness / 2.0 + 1;
+            // The live polyline may differ slightly from the committed one, so repaint both
+            const QRectF liveBounds = strokeInput.points().boundingRect().adjusted(-pad, -pad, pad, pad);
+
             Stroke s;
-            s.points = currentStroke;
+            s.points = strokeInput.finish();
             s.pen = QPen(drawColor, drawThickness, drawStyle, Qt::RoundCap, Qt::RoundJoin);
+            s.bounds = s.points.boundingRect().adjusted(-pad, -pad, pad, pad);
+            // Build the layer from the strokes so far first, or a rebuild would draw this one twice
+            ensureStrokeLayer();
             strokes.append(s);
-            currentStroke.clear();
+            bakeStroke(s);
+
+            const QRect area = annotationRect();
+            if (annotations && !area.isEmpty()) {
+                QPolygonF normalized;
+                normalized.reserve(s.points.size());
+                for (const QPointF &p : s.points) {
+                    normalized << QPointF((p.x() - area.x()) / area.width(), (p.y() - area.y()) / area.height());
+                }
+                AnnotationPen pen;
+                pen.color = drawColor.rgba();
+                pen.width = float(drawThickness) / area.width();
+                pen.style = quint32(drawStyle);
+                annotations->addStroke(currentPage, normalized, pen);
+            }
+            updateSurface(s.bounds.united(liveBounds).toAlignedRect());
+        }
+    }
+}
+
+RenderRequest PresentationDisplay::requestForPage(int page, qreal resolutionScale) const
+{
+    // Pages in the package are never rendered, so there is nothing to prefetch either
+    if (!renderer || (package && page >= 0 && page < package->pageCount())) return RenderRequest();
+
+    // Determine target size in physical pixels
+    QSize targetSize = size() * devicePixelRatio() * resolutionScale;
+    QSizeF pageSize = renderer->pagePointSize(page);
+
+    // In split view the logical slide is the left half of the page
+    QRectF crop = splitView ? QRectF(0, 0, 0.5, 1) : QRectF(0, 0, 1, 1);
+    return RenderRequest::fitted(page, pageSize, targetSize, crop, devicePixelRatio());
+}
+
+void PresentationDisplay::cancelPendingRenders()
+{
+    if (renderer) {
+        renderer->cancel(pendingTicket);
+        renderer->cancel(placeholderTicket);
+        for (auto it = pendingTiles.constBegin(); it != pendingTiles.constEnd(); ++it) {
+            renderer->cancel(it.key());
         }
-        update();
     }
+    pendingTicket = 0;
+    placeholderTicket = 0;
+    pendingTiles.clear();
 }
 
 void PresentationDisplay::renderCurrentSlide()
 {
-    if (!pdf || pdf->status() != QPdfDocument::Status::Ready) {
+    ProfileScope scope("renderCurrentSlide");
+    cancelPendingRenders();
+    previousPageShown = false;
+
+    // Playback: the frame is already in the mapped package, shown as is
+    if (package) {
+        RenderRequest request;
+        const QImage frame = package->frame(currentPage, splitView ? SlidePackage::SlideHalf : SlidePackage::FullPage,
+                                            devicePixelRatio(), &request);
+        if (!frame.isNull()) {
+            // Frames are blitted as compiled; any other window size rescales them on every paint
+            const QSize physical = size() * devicePixelRatio();
+            if (physical != package->box() && physical != warnedPackageSize) {
+                warnedPackageSize = physical;
+                qWarning("Slide package was compiled for %dx%d but the audience window is %dx%d; frames are rescaled",
+                         package->box().width(), package->box().height(), physical.width(), physical.height());
+            }
+            if (request != slideRequest) clearZoomTiles();
+            slideRequest = request;
+            cachedSlide = frame;
+            setSlideQuality(FullQuality);
+            return;
+        }
+    }
+
+    // Page geometry is all the display needs; the renderer owns the document
+    if (!renderer || !renderer->isReady()) {
         cachedSlide = QImage();
+        setSlideQuality(NoSlide);
         return;
     }
 
-    // Determine target size in physical pixels
-    QSize targetSize = size() * devicePixelRatio();
-    QSizeF pageSize = pdf->pagePointSize(currentPage);
+    RenderRequest request = requestForPage(currentPage);
+    if (request != slideRequest) clearZoomTiles();
+    slideRequest = request;
+    if (zoomActive) requestZoomTiles();
 
-    if (splitView) {
-        // Logical slide size is half the page width
-        QSizeF slideSize(pageSize.width() / 2.0, pageSize.height());
-        
-        // Calculate aspect-ratio preserving scale to fit targetSize
-        QSize scaledSize = slideSize.scaled(targetSize, Qt::KeepAspectRatio).toSize();
-        
-        // Calculate the full render size based on this scale
-        // Explicitly calculate scale factor to apply to full page
-        qreal scale = (qreal)scaledSize.width() / slideSize.width();
-        
-        QSize fullRenderSize(pageSize.width() * scale, pageSize.height() * scale);
-        
-        QImage fullImg = pdf->render(currentPage, fullRenderSize);
-        cachedSlide = fullImg.copy(0, 0, fullImg.width() / 2, fullImg.height());
+    if (tiled) {
+        renderTiles(request);
+        return;
+    }
+
+    // Revisited slides come straight from the shared cache
+    QImage cached = renderer->cachedImage(request);
+    if (!cached.isNull()) {
+        cachedSlide = cached;
+        setSlideQuality(FullQuality);
+        return;
+    }
+
+    // Show the new page immediately: any cached resolution of it (e.g. the console's
+    // copy), upscaled, or else a quick quarter-resolution render that lands first.
+    QImage placeholder = renderer->cachedPlaceholder(request);
+    if (!placeholder.isNull()) {
+        cachedSlide = placeholder;
+        setSlideQuality(Placeholder);
     } else {
-        // Standard mode: fit page to target size keeping aspect ratio
-        QSize renderSize = pageSize.scaled(targetSize, Qt::KeepAspectRatio).toSize();
-        cachedSlide = pdf->render(currentPage, renderSize);
+        // Nothing of the new page yet: the previous one stays up, no longer counted
+        // as final, until the quick render lands and replaces it
+        previousPageShown = !cachedSlide.isNull();
+        setSlideQuality(Placeholder);
+        placeholderTicket = renderer->requestRender(requestForPage(currentPage, 0.25));
     }
-    
-    cachedSlide.setDevicePixelRatio(devicePixelRatio());
+
+    // Full quality replaces whatever is shown once it arrives
+    pendingTicket = renderer->requestRender(request);
 }
 
-void PresentationDisplay::paintEvent(QPaintEvent *)
+void PresentationDisplay::renderTiles(const RenderRequest &request)
 {
-    QPainter painter(this);
-    
-    // Draw black background
-    painter.fillRect(rect(), Qt::black);
+    if (!request.isValid()) {
+        cachedSlide = QImage();
+        setSlideQuality(NoSlide);
+        return;
+    }
 
-    if (cachedSlide.isNull()) return;
+    // Already rendered whole (the prefetcher warms whole slides): nothing to split
+    QImage whole = renderer->cachedImage(request);
+    if (!whole.isNull()) {
+        cachedSlide = whole;
+        setSlideQuality(FullQuality);
+        return;
+    }
+
+    // The slide region within the page raster, split into a grid of tiles
+    const QRect region = request.clip.isNull() ? QRect(QPoint(0, 0), request.pageSize) : request.clip;
+    QList<QRect> tiles;
+    for (int y = region.top(); y <= region.bottom(); y += kTileSize) {
+        for (int x = region.left(); x <= region.right(); x += kTileSize) {
+            tiles.append(QRect(x, y, kTileSize, kTileSize).intersected(region));
+        }
+    }
+    // Centre tiles first: that is where the audience looks
+    const QPoint centre = region.center();
+    std::sort(tiles.begin(), tiles.end(), [centre](const QRect &a, const QRect &b) {
+        return (a.center() - centre).manhattanLength() < (b.center() - centre).manhattanLength();
+    });
+
+    QImage frame(region.size(), QImage::Format_ARGB32_Premultiplied);
+    frame.fill(Qt::transparent);
+    QPainter painter(&frame);
+
+    // Until the tiles land, show whatever resolution of this page we already have
+    QImage placeholder = renderer->cachedPlaceholder(request);
+    if (!placeholder.isNull()) {
+        painter.setRenderHint(QPainter::SmoothPixmapTransform);
+        painter.drawImage(QRectF(frame.rect()), placeholder);
+    }
 
+    // Tiles are cached individually, so only missing ones are rendered
+    for (const QRect &tile : tiles) {
+        RenderRequest tileRequest = request;
+        tileRequest.clip = tile;
+        const QRect target = tile.translated(-region.topLeft());
+        QImage cached = renderer->cachedImage(tileRequest);
+        if (!cached.isNull()) {
+            painter.drawImage(QRectF(target), cached);
+        } else {
+            if (quint64 ticket = renderer->requestRender(tileRequest)) pendingTiles.insert(ticket, target);
+        }
+    }
+    painter.end();
+
+    cachedSlide = frame;
+    setSlideQuality(pendingTiles.isEmpty() ? FullQuality : Placeholder);
+}
+
+void PresentationDisplay::setPackage(const SlidePackage *p)
+{
+    if (package == p) return;
+    // Nothing on screen may keep pointing into the mapping of the old package
+    if (transitioning) finishTransition();
+    transitionFrom = QImage();
+    cachedSlide = QImage();
+    clearZoomTiles();
+    package = p;
+    refreshSlide();
+}
+
+void PresentationDisplay::setTiledRendering(bool enabled)
+{
+    if (tiled == enabled) return;
+    tiled = enabled;
+    // PDFium renders one tile at a time, but more workers keep the queue moving
+    // while finished tiles are handed back and composited
+    if (tiled && renderer) renderer->ensureWorkerCount(QThread::idealThreadCount());
+    refreshSlide();
+}
+
+QRect PresentationDisplay::slideTargetRect() const
+{
     // Center the slide while maintaining aspect ratio
-    QSize slideSize = cachedSlide.size(); // Logical size due to DPR
+    QSize slideSize = cachedSlide.size();
     slideSize.scale(size(), Qt::KeepAspectRatio);
-    
+
     QRect slideRect(QPoint(0, 0), slideSize);
     slideRect.moveCenter(rect().center());
+    return slideRect;
+}
+
+QRect PresentationDisplay::slideRegion() const
+{
+    return slideRequest.clip.isNull() ? QRect(QPoint(0, 0), slideRequest.pageSize) : slideRequest.clip;
+}
+
+void PresentationDisplay::clearZoomTiles()
+{
+    if (renderer) {
+        for (auto it = pendingZoomTiles.constBegin(); it != pendingZoomTiles.constEnd(); ++it) {
+            renderer->cancel(it.key());
+        }
+    }
+    pendingZoomTiles.clear();
+    zoomTiles.clear();
+    zoomPageSize = QSize();
+}
+
+void PresentationDisplay::requestZoomTiles()
+{
+    // The lens magnifies the packaged frame instead of rendering during the talk
+    if (package || !renderer || !slideRequest.isValid() || cachedSlide.isNull()) return;
+
+    const QRect slideRect = slideTargetRect();
+    const QRect region = slideRegion();
+    if (slideRect.isEmpty() || region.isEmpty()) return;
+
+    QSize zoomedPage = slideRequest.pageSize * zoomFactor;
+    if (zoomedPage != zoomPageSize) {
+        clearZoomTiles();
+        zoomPageSize = zoomedPage;
+    }
+
+    // Lens source area in widget coordinates -> zoomed page raster coordinates
+    const qreal srcR = (zoomDiameter / 2) / zoomFactor;
+    const qreal k = qreal(region.width()) / slideRect.width(); // Page raster pixels per widget pixel
+    auto toZoomed = [&](qreal wx, qreal wy) {
+        return QPointF((region.x() + (wx - slideRect.x()) * k) * zoomFactor,
+                       (region.y() + (wy - slideRect.y()) * k) * zoomFactor);
+    };
+    const QRectF source(toZoomed(mousePos.x() - srcR, mousePos.y() - srcR),
+                        toZoomed(mousePos.x() + srcR, mousePos.y() + srcR));
+    const QRect zoomedRegion = QRectF(region.x() * zoomFactor, region.y() * zoomFactor,
+                                      region.width() * zoomFactor, region.height() * zoomFactor)
+                                   .toAlignedRect()
+                                   .intersected(QRect(QPoint(0, 0), zoomPageSize));
+    const QRect needed = source.toAlignedRect().intersected(zoomedRegion);
+    if (needed.isEmpty()) return;
+
+    // Lens regions are quantized to a tile grid so they can be cached and reused
+    QSet<quint64> neededKeys;
+    for (int row = needed.top() / kTileSize; row <= needed.bottom() / kTileSize; ++row) {
+        for (int col = needed.left() / kTileSize; col <= needed.right() / kTileSize; ++col) {
+            neededKeys.insert((quint64(row) << 32) | quint32(col));
+        }
+    }
+
+    // Only the tiles under the lens are kept here; the shared cache holds the rest
+    for (auto it = zoomTiles.begin(); it != zoomTiles.end();) {
+        if (neededKeys.contains(it.key())) ++it;
+        else it = zoomTiles.erase(it);
+    }
+    QSet<quint64> inFlight;
+    for (auto it = pendingZoomTiles.begin(); it != pendingZoomTiles.end();) {
+        if (neededKeys.contains(it.value())) {
+            inFlight.insert(it.value());
+            ++it;
+        } else {
+            renderer->cancel(it.key());
+            it = pendingZoomTiles.erase(it);
+        }
+    }
+
+    for (quint64 key : neededKeys) {
+        if (zoomTiles.contains(key) || inFlight.contains(key)) continue;
+        const int row = int(key >> 32);
+        const int col = int(quint32(key));
+
+        RenderRequest tile = slideRequest;
+        tile.pageSize = zoomPageSize;
+        tile.clip = QRect(col * kTileSize, row * kTileSize, kTileSize, kTileSize).intersected(zoomedRegion);
+        if (tile.clip.isEmpty()) continue;
+
+        QImage cached = renderer->cachedImage(tile);
+        if (!cached.isNull()) {
+            zoomTiles.insert(key, cached);
+        } else {
+            if (quint64 ticket = renderer->requestRender(tile)) pendingZoomTiles.insert(ticket, key);
+        }
+    }
+}
+
+void PresentationDisplay::drawZoomTiles(QPainter &painter, const QRect &slideRect, const QPoint &center)
+{
+    if (zoomTiles.isEmpty()) return;
+
+    const QRect region = slideRegion();
+    if (region.isEmpty() || slideRect.isEmpty()) return;
+    const QRect zoomedRegion = QRectF(region.x() * zoomFactor, region.y() * zoomFactor,
+                                      region.width() * zoomFactor, region.height() * zoomFactor)
+                                   .toAlignedRect()
+                                   .intersected(QRect(QPoint(0, 0), zoomPageSize));
+
+    // Zoomed page raster coordinates -> widget coordinates -> magnified lens coordinates
+    const qreal k = qreal(region.width()) / slideRect.width();
+    auto toLens = [&](qreal zx, qreal zy) {
+        qreal wx = slideRect.x() + (zx / zoomFactor - region.x()) / k;
+        qreal wy = slideRect.y() + (zy / zoomFactor - region.y()) / k;
+        return QPointF(center.x() + (wx - center.x()) * zoomFactor,
+                       center.y() + (wy - center.y()) * zoomFactor);
+    };
+
+    for (auto it = zoomTiles.constBegin(); it != zoomTiles.constEnd(); ++it) {
+        const int row = int(it.key() >> 32);
+        const int col = int(quint32(it.key()));
+        const QRect tileRect = QRect(col * kTileSize, row * kTileSize, kTileSize, kTileSize).intersected(zoomedRegion);
+        const QRectF target(toLens(tileRect.left(), tileRect.top()),
+                            toLens(tileRect.left() + tileRect.width(), tileRect.top() + tileRect.height()));
+        painter.drawImage(target, it.value());
+    }
+}
+
+void PresentationDisplay::onImageReady(quint64 ticket, const RenderRequest &, const QImage &image)
+{
+    auto zoomTile = pendingZoomTiles.find(ticket);
+    if (zoomTile != pendingZoomTiles.end()) {
+        // A failed tile stays missing and is asked for again when the lens moves
+        if (!image.isNull()) zoomTiles.insert(zoomTile.value(), image);
+        pendingZoomTiles.erase(zoomTile);
+        if (zoomActive) updateSurface(lensBounds(mousePos));
+        return;
+    }
+
+    auto tile = pendingTiles.find(ticket);
+    if (tile != pendingTiles.end()) {
+        if (image.isNull()) {
+            // The frame can no longer be completed: keep it as a placeholder
+            pendingTiles.erase(tile);
+            for (auto it = pendingTiles.cbegin(); it != pendingTiles.cend(); ++it) renderer->cancel(it.key());
+            pendingTiles.clear();
+            return;
+        }
+        // Composite the tile into the frame; frame pixels map 1:1 to tile pixels
+        QPainter painter(&cachedSlide);
+        painter.setCompositionMode(QPainter::CompositionMode_Source);
+        painter.drawImage(QRectF(tile.value()), image);
+        painter.end();
+        pendingTiles.erase(tile);
+        if (pendingTiles.isEmpty()) setSlideQuality(FullQuality);
+        updateSurface();
+        return;
+    }
+
+    if (image.isNull()) {
+        // Failed render: whatever is on screen stays up, without claiming full quality
+        if (ticket == pendingTicket) pendingTicket = 0;
+        else if (ticket == placeholderTicket) placeholderTicket = 0;
+        return;
+    }
+
+    if (ticket == pendingTicket) {
+        pendingTicket = 0;
+        renderer->cancel(placeholderTicket);
+        placeholderTicket = 0;
+        cachedSlide = image;
+        previousPageShown = false;
+        setSlideQuality(FullQuality);
+        updateSurface();
+    } else if (ticket == placeholderTicket) {
+        placeholderTicket = 0;
+        cachedSlide = image;
+        previousPageShown = false;
+        setSlideQuality(Placeholder);
+        updateSurface();
+    }
+}
+
+void PresentationDisplay::setSlideQuality(SlideQuality q)
+{
+    finalSlidePage = q == FullQuality ? currentPage : -1;
+    if (quality != q) {
+        quality = q;
+        emit slideQualityChanged(quality);
+    }
+    // Also for cache hits, which leave the quality unchanged
+    if (q == FullQuality) emit slideReady(currentPage);
+}
+
+void PresentationDisplay::setHardwareCompositing(bool enabled)
+{
+    if (enabled == (glSurface != nullptr)) return;
+    if (enabled) {
+        glSurface = new AudienceGLSurface([this](QPainter &painter, const QRect &area) {
+            paintScene(painter, area);
+        }, this);
+        glSurface->setGeometry(rect());
+        // Swaps block on vsync, so requesting the next frame from here paces animations
+        connect(glSurface, &QOpenGLWidget::frameSwapped, this, [this]() {
+            if (transitioning) {
+                transitionFrameDue = true;
+                glSurface->update();
+            }
+        });
+        glSurface->show();
+    } else {
+        delete glSurface;
+        glSurface = nullptr;
+    }
+    updateSurface();
+}
+
+void PresentationDisplay::updateSurface()
+{
+    if (glSurface) glSurface->update();
+    else update();
+}
+
+void PresentationDisplay::updateSurface(const QRegion &area)
+{
+    // GL frames are always redrawn whole; what they save is re-uploading the slide
+    if (glSurface) glSurface->update();
+    else update(area);
+}
+
+void PresentationDisplay::paintEvent(QPaintEvent *event)
+{
+    // The GL surface covers the window and paints the scene itself
+    if (glSurface) return;
+    QPainter painter(this);
+    paintScene(painter, event->rect());
+}
+
+void PresentationDisplay::paintHighlights(QPainter &painter, const QRect &slideRect, const QRect &dirty)
+{
+    // Normalized page -> page raster pixels -> widget; slideRegion() is what the raster shows
+    const QRect region = slideRegion();
+    if (region.isEmpty()) return;
+    const QSizeF page = slideRequest.pageSize;
+    const qreal sx = qreal(slideRect.width()) / region.width();
+    const qreal sy = qreal(slideRect.height()) / region.height();
+
+    painter.save();
+    painter.setClipRect(slideRect.intersected(dirty));
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(255, 220, 0, 96));
+    for (const QRectF &r : highlights) {
+        // Padded slightly so the marker covers ascenders and descenders
+        QRectF target(slideRect.x() + (r.x() * page.width() - region.x()) * sx,
+                      slideRect.y() + (r.y() * page.height() - region.y()) * sy,
+                      r.width() * page.width() * sx, r.height() * page.height() * sy);
+        painter.drawRoundedRect(target.adjusted(-2, -2, 2, 2), 3, 3);
+    }
+    painter.restore();
+}
+
+void PresentationDisplay::paintScene(QPainter &painter, const QRect &dirty)
+{
+    ProfileScope scope("audience paint");
+
+    if (transitioning) {
+        // Strokes, lens and partial repaints resume once the new slide has settled
+        paintTransition(painter);
+        RenderProfiler::endPageTurn(currentPage);
+        return;
+    }
+
+    // Everything below is limited to the area that actually changed
     
-    painter.drawImage(slideRect, cachedSlide);
+    // Draw black background
+    painter.fillRect(dirty, Qt::black);
 
-    // Draw Strokes
-    painter.setRenderHint(QPainter::Antialiasing);
-    for (const Stroke &s : strokes) {
-        painter.setPen(s.pen);
-        painter.drawPolyline(s.points);
+    if (cachedSlide.isNull()) return;
+
+    QRect slideRect = slideTargetRect();
+
+    // Placeholders are upscaled; filter them so they look soft rather than blocky
+    if (quality == Placeholder) painter.setRenderHint(QPainter::SmoothPixmapTransform);
+
+    // Blit only the part of the slide under the dirty area
+    QRect slideDirty = dirty.intersected(slideRect);
+    if (!slideDirty.isEmpty()) {
+        qreal sx = qreal(cachedSlide.width()) / slideRect.width();
+        qreal sy = qreal(cachedSlide.height()) / slideRect.height();
+        QRectF source((slideDirty.x() - slideRect.x()) * sx, (slideDirty.y() - slideRect.y()) * sy,
+                      slideDirty.width() * sx, slideDirty.height() * sy);
+        painter.drawImage(QRectF(slideDirty), cachedSlide, source);
+    }
+    // The audience now sees the final raster of the page the presenter turned to
+    if (quality == FullQuality && finalSlidePage == currentPage && !refreshQueued) RenderProfiler::endPageTurn(currentPage);
+
+    // The new page's highlights would land on the wrong words of the previous one
+    if (highlightPage == currentPage && !previousPageShown) paintHighlights(painter, slideRect, dirty);
+
+    // Draw Strokes: committed ones are a single blit of the baked layer
+    if (!strokes.isEmpty()) {
+        ensureStrokeLayer();
+        const qreal dpr = strokeLayer.devicePixelRatio();
+        painter.drawImage(QRectF(dirty), strokeLayer,
+                          QRectF(dirty.x() * dpr, dirty.y() * dpr, dirty.width() * dpr, dirty.height() * dpr));
     }
+    painter.setRenderHint(QPainter::Antialiasing);
     
-    if (!currentStroke.isEmpty()) {
+    if (!strokeInput.isEmpty()) {
         QPen pen(drawColor, drawThickness, drawStyle, Qt::RoundCap, Qt::RoundJoin);
         painter.setPen(pen);
-        painter.drawPolyline(currentStroke);
+        painter.drawPolyline(strokeInput.points());
     }
 
     // Draw Magnifier
@@ -454,6 +1212,9 @@ void PresentationDisplay::paintEvent(QPaintEvent *)
         painter.drawImage(QRect(center.x() - r, center.y() - r, zoomDiameter, zoomDiameter), 
                           cachedSlide, 
                           QRectF(imgSrcX, imgSrcY, imgSrcW, imgSrcH));
+
+        // Sharp tiles rendered at zoomFactor x slide resolution cover the upsampled fallback
+        drawZoomTiles(painter, slideRect, center);
                           
         painter.setClipping(false);
         painter.setPen(QPen(Qt::darkGray, 2));
@@ -0,0 +1,254 @@
+#include "rasterdiskcache.h"
+#include "renderprofiler.h"
+#include "sliderenderer.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+#include <cstring>
+
+namespace {
+const char kMagic[4] = { 'M', 'P', 'R', 'C' };
+const quint32 kVersion = 1;
+const int kCompressionLevel = 1; // Slides are mostly flat colour; level 1 already shrinks them several times
+
+// Precedes the compressed pixels of every raster file. Native byte order: the
+// cache never leaves the machine.
+struct FileHeader {
+    char magic[4];
+    quint32 version;
+    qint32 width;
+    qint32 height;
+    qint32 bytesPerLine;
+    qint32 format;
+    qint64 payload; // Bytes of compressed pixels that follow
+};
+
+qint64 nowMs()
+{
+    return QDateTime::currentMSecsSinceEpoch();
+}
+}
+
+RasterDiskCache::RasterDiskCache(const QString &directory, qint64 budgetBytes)
+    : root(directory), budget(budgetBytes), scanned(false), usedBytes(0)
+{
+}
+
+QString RasterDiskCache::defaultDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/rasters";
+}
+
+QString RasterDiskCache::recordPath(const QString &filePath) const
+{
+    const QByteArray pathHash = QCryptographicHash::hash(QFileInfo(filePath).canonicalFilePath().toUtf8(),
+                                                         QCryptographicHash::Sha1).toHex();
+    return root + "/files/" + QString::fromLatin1(pathHash);
+}
+
+QByteArray RasterDiskCache::fileStamp(const QString &filePath)
+{
+    const QFileInfo info(filePath);
+    return QByteArray::number(info.size()) + ' ' + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+}
+
+QByteArray RasterDiskCache::knownDocumentKey(const QString &filePath)
+{
+    if (!QFileInfo::exists(filePath)) return QByteArray();
+    // Seen before with the same size and mtime: trust the recorded key
+    QFile record(recordPath(filePath));
+    if (!record.open(QIODevice::ReadOnly)) return QByteArray();
+    const QList<QByteArray> parts = record.readAll().trimmed().split(' ');
+    return parts.size() == 3 && parts[0] + ' ' + parts[1] == fileStamp(filePath) ? parts[2] : QByteArray();
+}
+
+QByteArray RasterDiskCache::documentKey(const QString &filePath)
+{
+    const QByteArray known = knownDocumentKey(filePath);
+    if (!known.isEmpty()) return known;
+
+    // New or touched: hash the content, which finds the entries of an identical copy
+    const QByteArray stamp = fileStamp(filePath);
+    const QByteArray key = contentKey(filePath);
+    if (key.isEmpty()) return QByteArray();
+
+    QDir().mkpath(root + "/files");
+    QSaveFile out(recordPath(filePath));
+    if (out.open(QIODevice::WriteOnly)) {
+        out.write(stamp + ' ' + key);
+        out.commit();
+    }
+    return key;
+}
+
+QByteArray RasterDiskCache::contentKey(const QString &filePath)
+{
+    QFile pdf(filePath);
+    if (!pdf.open(QIODevice::ReadOnly)) return QByteArray();
+    ProfileScope scope("content hash");
+    QCryptographicHash hash(QCryptographicHash::Blake2b_160);
+    if (uchar *data = pdf.size() > 0 ? pdf.map(0, pdf.size()) : nullptr) {
+        hash.addData(QByteArray::fromRawData(reinterpret_cast<const char *>(data), pdf.size()));
+        pdf.unmap(data);
+    } else {
+        hash.addData(&pdf);
+    }
+    return hash.result().toHex();
+}
+
+bool RasterDiskCache::loadPageSizes(const QByteArray &document, QList<QSizeF> *sizes)
+{
+    QFile file(root + '/' + QString::fromLatin1(document) + "/pages");
+    if (document.isEmpty() || !file.open(QIODevice::ReadOnly)) return false;
+    QDataStream in(&file);
+    quint32 version = 0;
+    in >> version >> *sizes;
+    return in.status() == QDataStream::Ok && version == kVersion && !sizes->isEmpty();
+}
+
+void RasterDiskCache::storePageSizes(const QByteArray &document, const QList<QSizeF> &sizes)
+{
+    if (document.isEmpty() || sizes.isEmpty()) return;
+    const QString dir = root + '/' + QString::fromLatin1(document);
+    QDir().mkpath(dir);
+    QSaveFile file(dir + "/pages");
+    if (!file.open(QIODevice::WriteOnly)) return;
+    QDataStream out(&file);
+    out << kVersion << sizes;
+    file.commit();
+}
+
+QString RasterDiskCache::entryPath(const QByteArray &document, const RenderRequest &request) const
+{
+    // The DPR is not part of the pixels, so it is not part of the name either
+    QString name = QString("%1-%2x%3").arg(request.page).arg(request.pageSize.width()).arg(request.pageSize.height());
+    if (!request.clip.isNull()) {
+        name += QString("-%1,%2,%3x%4").arg(request.clip.x()).arg(request.clip.y())
+                    .arg(request.clip.width()).arg(request.clip.height());
+    }
+    return root + '/' + QString::fromLatin1(document) + '/' + name + ".mpr";
+}
+
+QImage RasterDiskCache::load(const QByteArray &document, const RenderRequest &request)
+{
+    if (document.isEmpty() || !request.isValid()) return QImage();
+    const QString path = entryPath(document, request);
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) return QImage();
+    const qint64 fileSize = file.size();
+    if (fileSize < qint64(sizeof(FileHeader))) return QImage();
+
+    ProfileScope scope("disk cache read");
+    uchar *data = file.map(0, fileSize);
+    if (!data) return QImage();
+    FileHeader header;
+    std::memcpy(&header, data, sizeof header);
+
+    // Decompressed straight into the buffer the image keeps. Everything QImage
+    // would reject is checked first: it does not run the cleanup for a null image.
+    QImage image;
+    const bool formatValid = header.format > QImage::Format_Invalid && header.format < QImage::NImageFormats;
+    const qint64 minBytesPerLine = formatValid
+        ? (qint64(header.width) * QImage::toPixelFormat(QImage::Format(header.format)).bitsPerPixel() + 31) / 32 * 4
+        : 0;
+    if (std::memcmp(header.magic, kMagic, sizeof kMagic) == 0 && header.version == kVersion
+        && header.payload == fileSize - qint64(sizeof header) && header.width > 0 && header.height > 0
+        && formatValid && header.bytesPerLine >= minBytesPerLine && header.bytesPerLine % 4 == 0) {
+        QByteArray *pixels = new QByteArray(qUncompress(data + sizeof header, header.payload));
+        if (pixels->size() == qint64(header.bytesPerLine) * header.height) {
+            image = QImage(reinterpret_cast<uchar *>(pixels->data()), header.width, header.height, header.bytesPerLine,
+                           QImage::Format(header.format),
+                           [](void *buffer) { delete static_cast<QByteArray *>(buffer); }, pixels);
+        } else {
+            delete pixels;
+        }
+    }
+    file.unmap(data);
+
+    if (image.isNull()) {
+        // Truncated, corrupt or written by another version
+        file.close();
+        QFile::remove(path);
+        return QImage();
+    }
+    image.setDevicePixelRatio(request.devicePixelRatio);
+
+    // The mtime doubles as last-use time, so eviction order survives restarts
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    QMutexLocker locker(&mutex);
+    if (scanned) noteUse(path, fileSize);
+    return image;
+}
+
+void RasterDiskCache::store(const QByteArray &document, const RenderRequest &request, const QImage &image)
+{
+    if (document.isEmpty() || !request.isValid() || image.isNull()) return;
+    ProfileScope scope("disk cache write");
+
+    const QByteArray payload = qCompress(image.constBits(), image.sizeInBytes(), kCompressionLevel);
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof kMagic);
+    header.version = kVersion;
+    header.width = image.width();
+    header.height = image.height();
+    header.bytesPerLine = image.bytesPerLine();
+    header.format = image.format();
+    header.payload = payload.size();
+
+    const QString path = entryPath(document, request);
+    QDir().mkpath(QFileInfo(path).path());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return;
+    file.write(reinterpret_cast<const char *>(&header), sizeof header);
+    file.write(payload);
+    if (!file.commit()) return;
+
+    QMutexLocker locker(&mutex);
+    ensureScanned();
+    noteUse(path, qint64(sizeof header) + payload.size());
+    if (usedBytes > budget) evict();
+}
+
+void RasterDiskCache::ensureScanned()
+{
+    if (scanned) return;
+    scanned = true;
+    // What earlier runs left behind counts against the budget too
+    QDirIterator it(root, { "*.mpr" }, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        entries.insert(info.filePath(), Entry{ info.size(), info.lastModified().toMSecsSinceEpoch() });
+        usedBytes += info.size();
+    }
+}
+
+void RasterDiskCache::noteUse(const QString &path, qint64 size)
+{
+    auto it = entries.find(path);
+    if (it != entries.end()) usedBytes -= it->size;
+    entries.insert(path, Entry{ size, nowMs() });
+    usedBytes += size;
+}
+
+void RasterDiskCache::evict()
+{
+    // Least recently used first, down to 90% so the next few writes do not evict again
+    QList<QString> paths = entries.keys();
+    std::sort(paths.begin(), paths.end(), [this](const QString &a, const QString &b) {
+        return entries.value(a).lastUsed < entries.value(b).lastUsed;
+    });
+    const qint64 target = budget * 9 / 10;
+    for (const QString &path : paths) {
+        if (usedBytes <= target) break;
+        QFile::remove(path);
+        usedBytes -= entries.take(path).size;
+    }
+}
@@ -0,0 +1,192 @@
+#include "renderprofiler.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSaveFile>
+#include <QSet>
+#include <QThread>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+namespace {
+const quint64 kCapacity = 1 << 15;
+const char *const kPageTurn = "page turn";
+
+// One ring buffer entry, guarded by a sequence number (seqlock): odd while a
+// writer fills it, 2 * (index + 1) once event 'index' is complete. Readers
+// drop entries whose sequence changed while they copied them.
+struct Slot {
+    std::atomic<quint64> sequence{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<qint64> start{0};
+    std::atomic<qint64> duration{0};
+    std::atomic<int> thread{0};
+};
+
+Slot ring[kCapacity];
+std::atomic<quint64> writeIndex{0};
+
+QElapsedTimer &clock()
+{
+    static QElapsedTimer timer = [] {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer;
+}
+
+// Thread numbering is the only locked path and runs once per thread
+QMutex threadMutex;
+QHash<int, QString> threadNames;
+int nextThread = 0;
+
+int registerThread()
+{
+    QMutexLocker locker(&threadMutex);
+    int number = ++nextThread;
+    QThread *thread = QThread::currentThread();
+    QString name = thread->objectName();
+    if (name.isEmpty()) {
+        bool gui = QCoreApplication::instance() && thread == QCoreApplication::instance()->thread();
+        name = gui ? QStringLiteral("GUI") : QStringLiteral("Thread %1").arg(number);
+    }
+    threadNames.insert(number, name);
+    return number;
+}
+
+int currentThreadNumber()
+{
+    thread_local int number = registerThread();
+    return number;
+}
+
+int pendingTurnPage = -1;
+qint64 pendingTurnStart = 0;
+}
+
+qint64 RenderProfiler::now()
+{
+    return clock().nsecsElapsed();
+}
+
+void RenderProfiler::record(const char *name, qint64 startNs, qint64 durationNs)
+{
+    const quint64 index = writeIndex.fetch_add(1, std::memory_order_relaxed);
+    Slot &slot = ring[index & (kCapacity - 1)];
+    slot.sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(startNs, std::memory_order_relaxed);
+    slot.duration.store(durationNs, std::memory_order_relaxed);
+    slot.thread.store(currentThreadNumber(), std::memory_order_relaxed);
+    slot.sequence.store(2 * index + 2, std::memory_order_release);
+}
+
+QList<RenderProfiler::Event> RenderProfiler::events()
+{
+    const quint64 end = writeIndex.load(std::memory_order_acquire);
+    const quint64 begin = end > kCapacity ? end - kCapacity : 0;
+
+    QList<Event> result;
+    result.reserve(int(end - begin));
+    for (quint64 index = begin; index < end; ++index) {
+        const Slot &slot = ring[index & (kCapacity - 1)];
+        const quint64 sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence != 2 * index + 2) continue; // Still being written, or already overwritten
+
+        Event e;
+        e.name = slot.name.load(std::memory_order_relaxed);
+        e.startNs = slot.start.load(std::memory_order_relaxed);
+        e.durationNs = slot.duration.load(std::memory_order_relaxed);
+        e.thread = slot.thread.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) != sequence) continue;
+        result.append(e);
+    }
+    return result;
+}
+
+RenderProfiler::Percentiles RenderProfiler::percentiles(const char *name)
+{
+    QList<qint64> durations;
+    const QList<Event> all = events();
+    for (const Event &e : all) {
+        if (e.name && std::strcmp(e.name, name) == 0) durations.append(e.durationNs);
+    }
+
+    Percentiles p;
+    p.samples = durations.size();
+    if (durations.isEmpty()) return p;
+    std::sort(durations.begin(), durations.end());
+    auto at = [&](double q) {
+        int i = qBound(0, int(q * durations.size() + 0.5) - 1, int(durations.size()) - 1);
+        return durations[i] / 1e6;
+    };
+    p.p50Ms = at(0.50);
+    p.p99Ms = at(0.99);
+    return p;
+}
+
+QString RenderProfiler::threadName(int thread)
+{
+    QMutexLocker locker(&threadMutex);
+    return threadNames.value(thread);
+}
+
+void RenderProfiler::beginPageTurn(int page)
+{
+    // A turn that never reached the audience (e.g. paged past quickly) is abandoned
+    pendingTurnPage = page;
+    pendingTurnStart = now();
+}
+
+void RenderProfiler::endPageTurn(int page)
+{
+    if (pendingTurnPage < 0 || page != pendingTurnPage) return;
+    record(kPageTurn, pendingTurnStart, now() - pendingTurnStart);
+    pendingTurnPage = -1;
+}
+
+bool RenderProfiler::exportChromeTrace(const QString &filePath)
+{
+    const QList<Event> all = events();
+
+    QJsonArray trace;
+    QSet<int> threads;
+    for (const Event &e : all) {
+        if (!e.name) continue;
+        QJsonObject event;
+        event["name"] = QString::fromLatin1(e.name);
+        event["ph"] = "X";
+        event["ts"] = e.startNs / 1000.0; // Microseconds
+        event["dur"] = e.durationNs / 1000.0;
+        event["pid"] = 1;
+        event["tid"] = e.thread;
+        trace.append(event);
+        threads.insert(e.thread);
+    }
+    for (int thread : threads) {
+        QJsonObject meta;
+        meta["name"] = "thread_name";
+        meta["ph"] = "M";
+        meta["pid"] = 1;
+        meta["tid"] = thread;
+        meta["args"] = QJsonObject{{"name", threadName(thread)}};
+        trace.append(meta);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = trace;
+    root["displayTimeUnit"] = "ms";
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) return false;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
@@ -0,0 +1,192 @@
+#include "searchindex.h"
+#include <QSet>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+const int kSnippetBefore = 30; // Characters of context around the first match
+const int kSnippetAfter = 60;
+}
+
+QStringList SearchIndex::tokenize(const QString &text, QList<QPair<int, int>> *spans)
+{
+    QStringList words;
+    if (spans) spans->clear();
+    const int size = text.size();
+    int i = 0;
+    while (i < size) {
+        while (i < size && !text[i].isLetterOrNumber()) ++i;
+        const int start = i;
+        while (i < size && text[i].isLetterOrNumber()) ++i;
+        if (i > start) {
+            words.append(text.mid(start, i - start).toLower());
+            if (spans) spans->append({ start, i - start });
+        }
+    }
+    return words;
+}
+
+void SearchIndex::addPage(int page, const QString &text, const QList<QRectF> &wordBoxes)
+{
+    QList<QPair<int, int>> spans;
+    const QStringList words = tokenize(text, &spans);
+
+    Page entry;
+    entry.text = text;
+    entry.words.reserve(words.size());
+    QHash<int, int> counts;
+    for (int i = 0; i < words.size(); ++i) {
+        int term = termIds.value(words[i], -1);
+        if (term < 0) {
+            term = terms.size();
+            termIds.insert(words[i], term);
+            terms.append(words[i]);
+            postings.append(QList<Posting>());
+        }
+        entry.words.append(Word{ term, spans[i].first, spans[i].second, wordBoxes.value(i) });
+        ++counts[term];
+    }
+    for (auto it = counts.cbegin(); it != counts.cend(); ++it) {
+        postings[it.key()].append(Posting{ page, it.value() });
+    }
+    pages.insert(page, entry);
+}
+
+void SearchIndex::finalize()
+{
+    sortedTerms.resize(terms.size());
+    for (int i = 0; i < sortedTerms.size(); ++i) sortedTerms[i] = i;
+    std::sort(sortedTerms.begin(), sortedTerms.end(), [this](int a, int b) { return terms[a] < terms[b]; });
+}
+
+void SearchIndex::clear()
+{
+    pages.clear();
+    termIds.clear();
+    terms.clear();
+    postings.clear();
+    sortedTerms.clear();
+}
+
+QList<int> SearchIndex::matchingTerms(const QString &word, bool prefix) const
+{
+    if (!prefix) {
+        const int term = termIds.value(word, -1);
+        return term < 0 ? QList<int>() : QList<int>{ term };
+    }
+
+    // All terms starting with 'word' are adjacent in lexical order
+    QList<int> result;
+    auto it = std::lower_bound(sortedTerms.cbegin(), sortedTerms.cend(), word,
+                               [this](int term, const QString &w) { return terms[term] < w; });
+    for (; it != sortedTerms.cend() && terms[*it].startsWith(word); ++it) result.append(*it);
+    return result;
+}
+
+QList<SearchIndex::Hit> SearchIndex::search(const QString &query, int limit) const
+{
+    const QStringList words = tokenize(query);
+    if (words.isEmpty() || pages.isEmpty()) return {};
+    // A trailing space means the last word is finished
+    const bool lastIsPrefix = !query.back().isSpace();
+
+    // Pages must contain every word; each adds its tf-idf to the page's score
+    QHash<int, double> scores;
+    for (int i = 0; i < words.size(); ++i) {
+        QHash<int, double> wordScores;
+        const bool prefix = lastIsPrefix && i == words.size() - 1;
+        for (int term : matchingTerms(words[i], prefix)) {
+            const QList<Posting> &list = postings[term];
+            // Rare words say more about a page than common ones
+            const double idf = std::log(1.0 + double(pages.size()) / list.size());
+            for (const Posting &p : list) {
+                if (i > 0 && !scores.contains(p.page)) continue;
+                wordScores[p.page] += (1.0 + std::log(double(p.count))) * idf;
+            }
+        }
+        if (i > 0) {
+            for (auto it = wordScores.begin(); it != wordScores.end(); ++it) it.value() += scores.value(it.key());
+        }
+        scores.swap(wordScores);
+        if (scores.isEmpty()) return {};
+    }
+
+    QList<Hit> hits;
+    hits.reserve(scores.size());
+    for (auto it = scores.cbegin(); it != scores.cend(); ++it) {
+        double score = it.value();
+        if (words.size() > 1 && containsPhrase(*pages.constFind(it.key()), words, lastIsPrefix)) score *= 2;
+        hits.append(Hit{ it.key(), score, QString() });
+    }
+    std::sort(hits.begin(), hits.end(), [](const Hit &a, const Hit &b) {
+        return a.score != b.score ? a.score > b.score : a.page < b.page;
+    });
+    if (hits.size() > limit) hits.resize(limit);
+
+    // Snippets only for what is shown
+    for (Hit &hit : hits) {
+        const Page &page = *pages.constFind(hit.page);
+        const QList<int> first = matchingWords(page, words, lastIsPrefix, true);
+        if (first.isEmpty()) continue;
+        const Word &match = page.words[first.first()];
+        const int start = qMax(0, match.offset - kSnippetBefore);
+        const int end = qMin(int(page.text.size()), match.offset + match.length + kSnippetAfter);
+        hit.snippet = page.text.mid(start, end - start).simplified();
+        if (start > 0) hit.snippet.prepend(QStringLiteral("..."));
+        if (end < page.text.size()) hit.snippet.append(QStringLiteral("..."));
+    }
+    return hits;
+}
+
+QList<QRectF> SearchIndex::matchesOnPage(int page, const QString &query) const
+{
+    auto it = pages.constFind(page);
+    const QStringList words = tokenize(query);
+    if (it == pages.cend() || words.isEmpty()) return {};
+
+    QList<QRectF> boxes;
+    for (int i : matchingWords(*it, words, !query.back().isSpace(), false)) {
+        const QRectF &box = it->words[i].box;
+        if (!box.isEmpty()) boxes.append(box);
+    }
+    return boxes;
+}
+
+QList<int> SearchIndex::matchingWords(const Page &page, const QStringList &words, bool lastIsPrefix,
+                                      bool firstOnly) const
+{
+    QSet<int> exact;
+    for (int i = 0; i < words.size() - (lastIsPrefix ? 1 : 0); ++i) {
+        const int term = termIds.value(words[i], -1);
+        if (term >= 0) exact.insert(term);
+    }
+    const QString prefix = lastIsPrefix ? words.last() : QString();
+
+    QList<int> matches;
+    for (int i = 0; i < page.words.size(); ++i) {
+        const int term = page.words[i].term;
+        if (exact.contains(term) || (!prefix.isEmpty() && terms[term].startsWith(prefix))) {
+            matches.append(i);
+            if (firstOnly) break;
+        }
+    }
+    return matches;
+}
+
+bool SearchIndex::containsPhrase(const Page &page, const QStringList &words, bool lastIsPrefix) const
+{
+    QList<int> ids;
+    for (const QString &word : words) ids.append(termIds.value(word, -1));
+
+    auto matches = [&](int k, int term) {
+        if (lastIsPrefix && k == words.size() - 1) return terms[term].startsWith(words[k]);
+        return term == ids[k];
+    };
+    const int span = words.size();
+    for (int start = 0; start + span <= page.words.size(); ++start) {
+        int k = 0;
+        while (k < span && matches(k, page.words[start + k].term)) ++k;
+        if (k == span) return true;
+    }
+    return false;
+}
@@ -0,0 +1,110 @@
+#include "slidecache.h"
+
+SlideCache::SlideCache(qint64 budgetBytes)
+    : hits(0), misses(0), evictions(0)
+{
+    setBudget(budgetBytes);
+}
+
+void SlideCache::setBudget(qint64 bytes)
+{
+    qsizetype before = images.count();
+    images.setMaxCost(qMax<qint64>(1, bytes / 1024));
+    evictions += before - images.count();
+}
+
+qint64 SlideCache::budget() const
+{
+    return qint64(images.maxCost()) * 1024;
+}
+
+QImage SlideCache::find(const SlideCacheKey &key)
+{
+    if (QImage *image = images.object(key)) {
+        ++hits;
+        return *image;
+    }
+    ++misses;
+    return QImage();
+}
+
+bool SlideCache::contains(const SlideCacheKey &key) const
+{
+    return images.contains(key);
+}
+
+QImage SlideCache::findAnyResolution(const SlideCacheKey &key) const
+{
+    // Compare clips in normalized page coordinates so different scales line up
+    auto normalizedClip = [](const SlideCacheKey &k) {
+        if (k.clip.isNull() || k.pageSize.isEmpty()) return QRectF(0, 0, 1, 1);
+        return QRectF(qreal(k.clip.x()) / k.pageSize.width(), qreal(k.clip.y()) / k.pageSize.height(),
+                      qreal(k.clip.width()) / k.pageSize.width(), qreal(k.clip.height()) / k.pageSize.height());
+    };
+    const QRectF wanted = normalizedClip(key);
+    const qreal tolerance = 0.01;
+
+    // The scan goes through the side index: QCache::object() would make every
+    // probed entry most recently used. Only the raster returned is refreshed.
+    const SlideCacheKey *best = nullptr;
+    qint64 bestArea = 0;
+    for (auto it = dimensions.cbegin(); it != dimensions.cend(); ++it) {
+        const SlideCacheKey &candidate = it.key();
+        if (candidate.document != key.document || candidate.page != key.page) continue;
+        QRectF region = normalizedClip(candidate);
+        if (qAbs(region.x() - wanted.x()) > tolerance || qAbs(region.y() - wanted.y()) > tolerance
+            || qAbs(region.width() - wanted.width()) > tolerance || qAbs(region.height() - wanted.height()) > tolerance) {
+            continue;
+        }
+        const qint64 area = qint64(it.value().width()) * it.value().height();
+        if (area > bestArea && images.contains(candidate)) {
+            best = &candidate;
+            bestArea = area;
+        }
+    }
+    const QImage *image = best ? images.object(*best) : nullptr;
+    return image ? *image : QImage();
+}
+
+void SlideCache::insert(const SlideCacheKey &key, const QImage &image)
+{
+    if (image.isNull()) return;
+
+    // QCache evicts least recently used entries to make room; count them
+    qsizetype before = images.count();
+    bool replaced = images.contains(key);
+    if (images.insert(key, new QImage(image), costOf(image))) {
+        evictions += before + (replaced ? 0 : 1) - images.count();
+        dimensions.insert(key, image.size());
+    }
+    // QCache does not report what it evicted, so stale index entries are dropped in bulk
+    if (dimensions.size() > 2 * images.count() + 16) {
+        for (auto it = dimensions.begin(); it != dimensions.end();) {
+            if (images.contains(it.key())) ++it;
+            else it = dimensions.erase(it);
+        }
+    }
+}
+
+void SlideCache::clear()
+{
+    images.clear();
+    dimensions.clear();
+}
+
+SlideCache::Stats SlideCache::stats() const
+{
+    Stats s;
+    s.hits = hits;
+    s.misses = misses;
+    s.evictions = evictions;
+    s.entries = images.count();
+    s.usedBytes = qint64(images.totalCost()) * 1024;
+    s.budgetBytes = budget();
+    return s;
+}
+
+qsizetype SlideCache::costOf(const QImage &image)
+{
+    return qMax<qsizetype>(1, image.sizeInBytes() / 1024);
+}
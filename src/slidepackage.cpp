@@ -0,0 +1,275 @@
+#include "slidepackage.h"
+#include "rasterdiskcache.h"
+#include "sliderenderer.h"
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QPdfDocument>
+#include <QThread>
+#include <QThreadPool>
+#include <atomic>
+#include <cstring>
+
+namespace {
+const char kMagic[4] = { 'M', 'P', 'P', 'K' };
+const quint32 kVersion = 2;
+const int kContentKeySize = 40; // Hex Blake2b-160, as RasterDiskCache::contentKey() returns
+const qint64 kFrameAlignment = 4096; // Frames start on a VM page, so each maps on its own
+const QImage::Format kFormat = QImage::Format_ARGB32_Premultiplied; // What QPdfDocument renders
+
+// Native byte order: a package is compiled on the machine that presents it
+struct FileHeader {
+    char magic[4];
+    quint32 version;
+    qint32 pageCount;
+    qint32 boxWidth;
+    qint32 boxHeight;
+    qint32 reserved;
+    qint64 sourceSize; // Bytes of the PDF it was compiled from
+    char contentKey[kContentKeySize]; // And a hash of them
+};
+
+// Entry (page * ViewCount + view) of the index that follows the header
+struct FrameEntry {
+    qint32 width;
+    qint32 height;
+    qint32 bytesPerLine;
+    qint32 pageWidth;   // RenderRequest::pageSize
+    qint32 pageHeight;
+    qint32 clipX;       // RenderRequest::clip, null for the whole page
+    qint32 clipY;
+    qint32 clipWidth;
+    qint32 clipHeight;
+    qint32 reserved;
+    qint64 offset;      // Of the pixels, from the start of the file
+};
+
+QRectF cropFor(SlidePackage::View view)
+{
+    return view == SlidePackage::SlideHalf ? QRectF(0, 0, 0.5, 1) : QRectF(0, 0, 1, 1);
+}
+
+const FileHeader *headerOf(const uchar *data)
+{
+    return reinterpret_cast<const FileHeader *>(data);
+}
+
+const FrameEntry *indexOf(const uchar *data)
+{
+    return reinterpret_cast<const FrameEntry *>(data + sizeof(FileHeader));
+}
+}
+
+SlidePackage::SlidePackage()
+    : data(nullptr), size(0)
+{
+}
+
+SlidePackage::~SlidePackage()
+{
+    close();
+}
+
+int SlidePackage::build(const QString &sourcePath, const QString &packagePath, const QSize &box, int jobs)
+{
+    if (box.isEmpty()) {
+        qCritical("No output size given");
+        return -1;
+    }
+
+    // Geometry of every frame is known up front, so the file is laid out before anything renders
+    QList<FrameEntry> entries;
+    FileHeader header;
+    {
+        QPdfDocument probe;
+        if (probe.load(sourcePath) != QPdfDocument::Error::None) {
+            qCritical("Cannot open %s", qPrintable(sourcePath));
+            return -1;
+        }
+        std::memcpy(header.magic, kMagic, sizeof kMagic);
+        header.version = kVersion;
+        header.pageCount = probe.pageCount();
+        header.boxWidth = box.width();
+        header.boxHeight = box.height();
+        header.reserved = 0;
+        header.sourceSize = QFileInfo(sourcePath).size();
+        const QByteArray key = RasterDiskCache::contentKey(sourcePath);
+        if (key.size() != kContentKeySize) {
+            qCritical("Cannot read %s", qPrintable(sourcePath));
+            return -1;
+        }
+        std::memcpy(header.contentKey, key.constData(), kContentKeySize);
+
+        for (int page = 0; page < header.pageCount; ++page) {
+            for (int view = 0; view < ViewCount; ++view) {
+                const RenderRequest request = RenderRequest::fitted(page, probe.pagePointSize(page), box,
+                                                                    cropFor(View(view)));
+                const QSize frameSize = request.outputSize();
+                const QRect clip = request.clip;
+                entries.append(FrameEntry{ frameSize.width(), frameSize.height(), frameSize.width() * 4,
+                                           request.pageSize.width(), request.pageSize.height(),
+                                           clip.x(), clip.y(), clip.width(), clip.height(), 0, 0 });
+            }
+        }
+    }
+    if (entries.isEmpty()) {
+        qCritical("%s has no pages", qPrintable(sourcePath));
+        return -1;
+    }
+
+    qint64 end = sizeof(FileHeader) + entries.size() * qint64(sizeof(FrameEntry));
+    for (FrameEntry &entry : entries) {
+        end = (end + kFrameAlignment - 1) / kFrameAlignment * kFrameAlignment;
+        entry.offset = end;
+        end += qint64(entry.bytesPerLine) * entry.height;
+    }
+
+    // Written under a temporary name, so a failed or interrupted build never leaves a package behind
+    const QString partPath = packagePath + ".part";
+    QFile out(partPath);
+    if (!out.open(QIODevice::ReadWrite | QIODevice::Truncate) || !out.resize(end)) {
+        qCritical("Cannot create %s: %s", qPrintable(partPath), qPrintable(out.errorString()));
+        return -1;
+    }
+    uchar *target = out.map(0, end);
+    if (!target) {
+        qCritical("Cannot map %s: %s", qPrintable(partPath), qPrintable(out.errorString()));
+        out.remove();
+        return -1;
+    }
+
+    const int workers = qBound(1, jobs > 0 ? jobs : QThread::idealThreadCount(), int(entries.size()));
+    QThreadPool pool;
+    pool.setMaxThreadCount(workers);
+
+    std::atomic<int> next{0};
+    std::atomic<int> written{0};
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int w = 0; w < workers; ++w) {
+        pool.start([&sourcePath, &box, &entries, &next, &written, target]() {
+            // One document per worker, as in batch export
+            QPdfDocument document;
+            if (document.load(sourcePath) != QPdfDocument::Error::None) return;
+
+            for (int i = next.fetch_add(1); i < entries.size(); i = next.fetch_add(1)) {
+                const FrameEntry &entry = entries[i];
+                const int page = i / ViewCount;
+                const RenderRequest request = RenderRequest::fitted(page, document.pagePointSize(page), box,
+                                                                    cropFor(View(i % ViewCount)));
+                QImage image = SlideRenderer::rasterize(&document, request);
+                if (image.format() != kFormat) image.convertTo(kFormat);
+                if (image.width() != entry.width || image.height() != entry.height) {
+                    qWarning("Failed to render page %d", page + 1);
+                    continue;
+                }
+                // Workers fill disjoint ranges of the mapping
+                uchar *frame = target + entry.offset;
+                for (int y = 0; y < entry.height; ++y) {
+                    std::memcpy(frame + qint64(y) * entry.bytesPerLine, image.constScanLine(y), entry.bytesPerLine);
+                }
+                ++written;
+            }
+        });
+    }
+    pool.waitForDone();
+
+    const int failed = int(entries.size()) - written.load();
+    if (failed == 0) {
+        std::memcpy(target, &header, sizeof header);
+        std::memcpy(target + sizeof header, entries.constData(), entries.size() * sizeof(FrameEntry));
+    }
+    out.unmap(target);
+    out.close();
+    if (failed > 0 || (QFile::exists(packagePath) && !QFile::remove(packagePath)) || !out.rename(packagePath)) {
+        if (failed == 0) qCritical("Cannot write %s", qPrintable(packagePath));
+        QFile::remove(partPath);
+        return qMax(failed, 1);
+    }
+
+    const double seconds = timer.elapsed() / 1000.0;
+    qInfo("Compiled %d pages (%d frames, %.0f MiB) at %dx%d in %.2f s (%d workers)", int(header.pageCount),
+          int(entries.size()), end / (1024.0 * 1024.0), box.width(), box.height(), seconds, workers);
+    return 0;
+}
+
+bool SlidePackage::open(const QString &path)
+{
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+    size = file.size();
+    if (size < qint64(sizeof(FileHeader))) {
+        close();
+        return false;
+    }
+
+    // A private mapping gives writable pointers, so the images never detach into copies
+    data = file.map(0, size, QFileDevice::MapPrivateOption);
+    if (!data) {
+        close();
+        return false;
+    }
+
+    const FileHeader *header = headerOf(data);
+    const qint64 indexEnd = sizeof(FileHeader) + qint64(header->pageCount) * ViewCount * qint64(sizeof(FrameEntry));
+    bool valid = std::memcmp(header->magic, kMagic, sizeof kMagic) == 0 && header->version == kVersion
+                 && header->pageCount > 0 && indexEnd <= size;
+    for (int i = 0; valid && i < header->pageCount * ViewCount; ++i) {
+        const FrameEntry &entry = indexOf(data)[i];
+        valid = entry.offset >= indexEnd && entry.bytesPerLine >= entry.width * 4
+                && entry.offset + qint64(entry.bytesPerLine) * entry.height <= size;
+    }
+    if (!valid) {
+        qWarning("%s is not a slide package from this version", qPrintable(path));
+        close();
+        return false;
+    }
+    return true;
+}
+
+void SlidePackage::close()
+{
+    if (data) file.unmap(data);
+    data = nullptr;
+    size = 0;
+    file.close();
+}
+
+int SlidePackage::pageCount() const
+{
+    return data ? headerOf(data)->pageCount : 0;
+}
+
+QSize SlidePackage::box() const
+{
+    return data ? QSize(headerOf(data)->boxWidth, headerOf(data)->boxHeight) : QSize();
+}
+
+bool SlidePackage::couldMatch(const QString &sourcePath, int pages) const
+{
+    // Size and page count rule most other decks out without reading them
+    return data && pages == pageCount() && QFileInfo(sourcePath).size() == headerOf(data)->sourceSize;
+}
+
+QByteArray SlidePackage::contentKey() const
+{
+    return data ? QByteArray(headerOf(data)->contentKey, kContentKeySize) : QByteArray();
+}
+
+QImage SlidePackage::frame(int page, View view, qreal devicePixelRatio, RenderRequest *request) const
+{
+    if (!data || page < 0 || page >= pageCount() || view < 0 || view >= ViewCount) return QImage();
+    const FrameEntry &entry = indexOf(data)[page * ViewCount + view];
+    if (entry.width <= 0 || entry.height <= 0) return QImage();
+
+    QImage image(data + entry.offset, entry.width, entry.height, entry.bytesPerLine, kFormat);
+    image.setDevicePixelRatio(devicePixelRatio);
+    if (request) {
+        request->page = page;
+        request->pageSize = QSize(entry.pageWidth, entry.pageHeight);
+        request->clip = QRect(entry.clipX, entry.clipY, entry.clipWidth, entry.clipHeight);
+        request->devicePixelRatio = devicePixelRatio;
+    }
+    return image;
+}
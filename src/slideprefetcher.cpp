@@ -0,0 +1,98 @@
+#include "slideprefetcher.h"
+#include <algorithm>
+
+namespace {
+// How many favourite TOC destinations are kept warm in addition to the window
+const int kJumpTargetsToPrefetch = 3;
+}
+
+SlidePrefetcher::SlidePrefetcher(SlideRenderer *renderer)
+    : renderer(renderer), ahead(2), behind(1), lastPage(-1), movingBackward(false), returnPage(-1)
+{
+}
+
+void SlidePrefetcher::addTarget(const RequestBuilder &builder)
+{
+    targets.append(builder);
+}
+
+void SlidePrefetcher::setWindow(int ahead, int behind)
+{
+    this->ahead = qMax(0, ahead);
+    this->behind = qMax(0, behind);
+}
+
+void SlidePrefetcher::noteJump(int fromPage, int toPage)
+{
+    if (fromPage == toPage) return;
+    returnPage = fromPage;
+    jumpTargets[toPage]++;
+    // A jump says nothing about reading direction; assume forward from the new spot
+    lastPage = toPage;
+    movingBackward = false;
+}
+
+void SlidePrefetcher::reset()
+{
+    for (quint64 ticket : tickets) renderer->cancel(ticket);
+    tickets.clear();
+    lastPage = -1;
+    movingBackward = false;
+    returnPage = -1;
+    jumpTargets.clear();
+}
+
+QList<int> SlidePrefetcher::candidatePages(int page) const
+{
+    QList<int> pages;
+    auto add = [&](int p) {
+        if (p >= 0 && p < renderer->pageCount() && p != page && !pages.contains(p)) pages.append(p);
+    };
+
+    // Walking backwards through the deck (e.g. during Q&A) flips the window
+    int forward = movingBackward ? behind : ahead;
+    int backward = movingBackward ? ahead : behind;
+    int step = movingBackward ? -1 : 1;
+
+    // Nearest pages first, in the direction of travel
+    for (int d = 1; d <= qMax(forward, backward); ++d) {
+        if (d <= forward) add(page + step * d);
+        if (d <= backward) add(page - step * d);
+    }
+
+    // After a TOC jump the presenter usually comes back
+    add(returnPage);
+
+    // Most visited TOC destinations
+    QList<QPair<int, int>> favourites;
+    for (auto it = jumpTargets.constBegin(); it != jumpTargets.constEnd(); ++it) {
+        favourites.append(qMakePair(it.value(), it.key()));
+    }
+    std::sort(favourites.begin(), favourites.end(), [](const QPair<int, int> &a, const QPair<int, int> &b) {
+        return a.first > b.first;
+    });
+    for (int i = 0; i < favourites.size() && i < kJumpTargetsToPrefetch; ++i) {
+        add(favourites[i].second);
+    }
+    return pages;
+}
+
+void SlidePrefetcher::schedule(int page)
+{
+    // Jobs for the previous position that have not started yet are no longer useful
+    for (quint64 ticket : tickets) renderer->cancel(ticket);
+    tickets.clear();
+
+    if (!renderer->isReady()) return;
+
+    if (lastPage >= 0 && page != lastPage) movingBackward = page < lastPage;
+    lastPage = page;
+
+    const QList<int> pages = candidatePages(page);
+    for (int p : pages) {
+        for (const RequestBuilder &build : targets) {
+            quint64 ticket = renderer->requestRender(build(p), SlideRenderer::Priority::Prefetch);
+            if (ticket) tickets.append(ticket);
+        }
+    }
+}
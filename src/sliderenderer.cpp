@@ -0,0 +1,426 @@
+#include "sliderenderer.h"
+#include "renderprofiler.h"
+#include "rasterdiskcache.h"
+#include <QPdfDocument>
+#include <QPdfDocumentRenderOptions>
+#include <QThread>
+#include <QThreadPool>
+#include <functional>
+
+namespace {
+// Pages between load progress reports
+const int kProgressStep = 256;
+// Rasters kept for the disk cache while a new deck is being hashed: the first slides
+const int kUnkeyedRasters = 8;
+}
+
+// Lives on a render thread. The document is created lazily on that thread.
+class RenderWorker : public QObject
+{
+public:
+    void ensureLoaded(const QString &filePath, quint64 generation)
+    {
+        if (document && loadedGeneration == generation) return;
+        ProfileScope scope("pdf load");
+        if (!document) document = new QPdfDocument(this);
+        document->load(filePath);
+        loadedGeneration = generation;
+    }
+
+    // Page geometry, reported in steps so huge documents show progress
+    QList<QSizeF> pageSizes(const std::function<void(int, int)> &progress)
+    {
+        QList<QSizeF> sizes;
+        if (!document || document->status() != QPdfDocument::Status::Ready) return sizes;
+        ProfileScope scope("page geometry");
+        const int count = document->pageCount();
+        sizes.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            sizes.append(document->pagePointSize(i));
+            if ((i + 1) % kProgressStep == 0 || i + 1 == count) progress(i + 1, count);
+        }
+        return sizes;
+    }
+
+    QImage render(const RenderRequest &request)
+    {
+        if (!document) return QImage();
+        ProfileScope scope("pdf render");
+        return SlideRenderer::rasterize(document, request);
+    }
+
+private:
+    QPdfDocument *document = nullptr;
+    quint64 loadedGeneration = 0;
+};
+
+RenderRequest RenderRequest::fitted(int page, const QSizeF &pagePointSize, const QSize &target,
+                                    const QRectF &crop, qreal dpr)
+{
+    RenderRequest r;
+    r.page = page;
+    r.devicePixelRatio = dpr;
+
+    QSizeF regionSize(pagePointSize.width() * crop.width(), pagePointSize.height() * crop.height());
+    if (regionSize.isEmpty() || target.isEmpty()) return r;
+
+    // Scale that makes the cropped region fit the target, applied to the full page
+    QSize fittedRegion = regionSize.scaled(target, Qt::KeepAspectRatio).toSize();
+    if (fittedRegion.isEmpty()) return r;
+    qreal scale = (qreal)fittedRegion.width() / regionSize.width();
+    r.pageSize = QSize(qRound(pagePointSize.width() * scale), qRound(pagePointSize.height() * scale));
+
+    if (crop != QRectF(0, 0, 1, 1)) {
+        QRect clip(qRound(crop.x() * r.pageSize.width()), qRound(crop.y() * r.pageSize.height()),
+                   fittedRegion.width(), fittedRegion.height());
+        r.clip = clip.intersected(QRect(QPoint(0, 0), r.pageSize));
+    }
+    return r;
+}
+
+QImage SlideRenderer::rasterize(QPdfDocument *document, const RenderRequest &request)
+{
+    if (document->status() != QPdfDocument::Status::Ready) return QImage();
+    if (request.page < 0 || request.page >= document->pageCount()) return QImage();
+
+    QImage image;
+    if (request.clip.isNull()) {
+        image = document->render(request.page, request.pageSize);
+    } else {
+        // Rasterize only the clipped region (e.g. one half of a Beamer notes page)
+        // straight into an image of its final size; nothing outside it is drawn.
+        QPdfDocumentRenderOptions options;
+        options.setScaledSize(request.pageSize);
+        options.setScaledClipRect(request.clip);
+        image = document->render(request.page, request.clip.size(), options);
+    }
+    image.setDevicePixelRatio(request.devicePixelRatio);
+    return image;
+}
+
+SlideRenderer::SlideRenderer(QObject *parent, int workerCount)
+    : QObject(parent), generation(0), nextTicket(0), pageSizesStored(false)
+{
+    // PDFium serializes most work internally, so a couple of workers is enough
+    // to keep one busy while another loads or hands back its result.
+    if (workerCount <= 0) workerCount = qBound(1, QThread::idealThreadCount() - 1, 2);
+
+    ensureWorkerCount(workerCount);
+}
+
+SlideRenderer::~SlideRenderer()
+{
+    for (WorkerSlot &slot : workers) {
+        slot.thread->quit();
+    }
+    for (WorkerSlot &slot : workers) {
+        slot.thread->wait();
+    }
+    // Started by the workers, and posts back to this object
+    hashPool.waitForDone();
+}
+
+void SlideRenderer::addWorker()
+{
+    WorkerSlot slot;
+    slot.thread = new QThread(this);
+    slot.thread->setObjectName(QString("SlideRenderer-%1").arg(workers.size()));
+    slot.worker = new RenderWorker();
+    slot.worker->moveToThread(slot.thread);
+    connect(slot.thread, &QThread::finished, slot.worker, &QObject::deleteLater);
+    slot.thread->start();
+    workers.append(slot);
+}
+
+void SlideRenderer::ensureWorkerCount(int count)
+{
+    while (workers.size() < count) {
+        addWorker();
+    }
+    dispatch();
+}
+
+QSizeF SlideRenderer::pagePointSize(int page) const
+{
+    return pageSizes.value(page);
+}
+
+void SlideRenderer::openDocument(const QString &filePath)
+{
+    sourcePath = filePath;
+    resetDocument();
+
+    RenderWorker *worker = workers.first().worker;
+    const quint64 openGeneration = generation;
+    const std::shared_ptr<RasterDiskCache> disk = diskCache;
+    QMetaObject::invokeMethod(worker, [this, worker, filePath, openGeneration, disk]() {
+        // A deck seen before: the geometry is on disk, and PDFium stays unloaded until a raster is missing
+        QList<QSizeF> sizes;
+        const QByteArray key = disk ? disk->knownDocumentKey(filePath) : QByteArray();
+        if (!key.isEmpty() && disk->loadPageSizes(key, &sizes)) {
+            QMetaObject::invokeMethod(this, [this, openGeneration, sizes, key]() {
+                onDocumentOpened(openGeneration, sizes, key);
+            }, Qt::QueuedConnection);
+            return;
+        }
+
+        // New or changed: hashing the whole file must not hold up the first slide,
+        // so it runs alongside the geometry pass and the key arrives when it can
+        if (disk) {
+            hashPool.start([this, disk, filePath, openGeneration]() {
+                const QByteArray key = disk->documentKey(filePath);
+                QMetaObject::invokeMethod(this, [this, openGeneration, key]() {
+                    onDocumentKey(openGeneration, key);
+                }, Qt::QueuedConnection);
+            });
+        }
+        worker->ensureLoaded(filePath, openGeneration);
+        sizes = worker->pageSizes([this, openGeneration](int done, int total) {
+            QMetaObject::invokeMethod(this, [this, openGeneration, done, total]() {
+                if (openGeneration == generation) emit loadProgress(done, total);
+            }, Qt::QueuedConnection);
+        });
+        QMetaObject::invokeMethod(this, [this, openGeneration, sizes]() {
+            onDocumentOpened(openGeneration, sizes, QByteArray());
+        }, Qt::QueuedConnection);
+    }, Qt::QueuedConnection);
+}
+
+void SlideRenderer::onDocumentOpened(quint64 openGeneration, const QList<QSizeF> &sizes, const QByteArray &contentKey)
+{
+    if (openGeneration != generation) return; // Another document was opened meanwhile
+    if (sizes.isEmpty()) {
+        emit loadFailed();
+        return;
+    }
+    pageSizes = sizes;
+    if (!contentKey.isEmpty()) {
+        // Both came from the disk cache
+        documentKey = contentKey;
+        pageSizesStored = true;
+    }
+    storePageSizes();
+    emit documentReady();
+}
+
+void SlideRenderer::onDocumentKey(quint64 openGeneration, const QByteArray &contentKey)
+{
+    if (openGeneration != generation || contentKey.isEmpty()) return;
+    // Rasters rendered from here on are kept on disk, and so are the first few before
+    documentKey = contentKey;
+    storePageSizes();
+    const std::shared_ptr<RasterDiskCache> disk = diskCache;
+    for (const QPair<RenderRequest, QImage> &raster : unkeyedRasters) {
+        QThreadPool::globalInstance()->start([disk, contentKey, raster]() {
+            disk->store(contentKey, raster.first, raster.second);
+        });
+    }
+    unkeyedRasters.clear();
+    emit contentKeyReady(contentKey);
+}
+
+void SlideRenderer::storePageSizes()
+{
+    // Once both geometry and key are known, whichever arrived second
+    if (pageSizesStored || !diskCache || documentKey.isEmpty() || pageSizes.isEmpty()) return;
+    pageSizesStored = true;
+    const std::shared_ptr<RasterDiskCache> disk = diskCache;
+    const QByteArray key = documentKey;
+    const QList<QSizeF> sizes = pageSizes;
+    QThreadPool::globalInstance()->start([disk, key, sizes]() { disk->storePageSizes(key, sizes); });
+}
+
+void SlideRenderer::resetDocument()
+{
+    // Anything queued or in flight belongs to the previous document
+    ++generation;
+    pending.clear();
+    pageSizes.clear();
+    documentKey.clear();
+    pageSizesStored = false;
+    unkeyedRasters.clear();
+    cache.clear();
+}
+
+SlideCacheKey SlideRenderer::cacheKey(const RenderRequest &request) const
+{
+    SlideCacheKey key;
+    key.document = generation;
+    key.page = request.page;
+    key.pageSize = request.pageSize;
+    key.clip = request.clip;
+    return key;
+}
+
+QImage SlideRenderer::cachedImage(const RenderRequest &request)
+{
+    if (!request.isValid()) return QImage();
+    QImage image = cache.find(cacheKey(request));
+    // The pixels do not depend on the DPR, so one entry serves every screen
+    if (!image.isNull() && !qFuzzyCompare(image.devicePixelRatio(), request.devicePixelRatio)) {
+        image.setDevicePixelRatio(request.devicePixelRatio);
+    }
+    return image;
+}
+
+QImage SlideRenderer::cachedPlaceholder(const RenderRequest &request) const
+{
+    if (!request.isValid()) return QImage();
+    return cache.findAnyResolution(cacheKey(request));
+}
+
+void SlideRenderer::setCacheBudget(qint64 bytes)
+{
+    cache.setBudget(bytes);
+}
+
+SlideCache::Stats SlideRenderer::cacheStats() const
+{
+    return cache.stats();
+}
+
+void SlideRenderer::setDiskCache(const QString &directory, qint64 budgetBytes)
+{
+    diskCache = directory.isEmpty() || budgetBytes <= 0 ? nullptr
+                                                        : std::make_shared<RasterDiskCache>(directory, budgetBytes);
+}
+
+quint64 SlideRenderer::requestRender(const RenderRequest &request, Priority priority)
+{
+    if (priority == Priority::Prefetch) {
+        if (!request.isValid() || sourcePath.isEmpty() || cache.contains(cacheKey(request))) return 0;
+    }
+
+    // Nothing would ever answer the ticket
+    if (!request.isValid() || sourcePath.isEmpty()) return 0;
+    quint64 ticket = ++nextTicket;
+
+    // Piggyback on an identical job that is already queued or running, unless
+    // it still renders the document that was open before
+    for (WorkerSlot &slot : workers) {
+        if (slot.busy && slot.generation == generation && slot.job.request == request) {
+            slot.job.tickets.append(ticket);
+            return ticket;
+        }
+    }
+    for (int i = 0; i < pending.size(); ++i) {
+        if (pending[i].request == request) {
+            Job job = pending.takeAt(i);
+            job.tickets.append(ticket);
+            // Someone is now waiting on a prefetch: move it up the queue
+            if (priority == Priority::Interactive) job.priority = Priority::Interactive;
+            enqueue(job);
+            dispatch();
+            return ticket;
+        }
+    }
+
+    Job job;
+    job.request = request;
+    job.tickets.append(ticket);
+    job.priority = priority;
+    enqueue(job);
+    dispatch();
+    return ticket;
+}
+
+void SlideRenderer::enqueue(const Job &job)
+{
+    if (job.priority == Priority::Prefetch) {
+        pending.append(job);
+        return;
+    }
+    // Interactive jobs go after other interactive ones but ahead of any prefetch
+    int pos = 0;
+    while (pos < pending.size() && pending[pos].priority == Priority::Interactive) ++pos;
+    pending.insert(pos, job);
+}
+
+void SlideRenderer::cancel(quint64 ticket)
+{
+    if (ticket == 0) return;
+    for (WorkerSlot &slot : workers) {
+        slot.job.tickets.removeAll(ticket);
+    }
+    for (int i = pending.size() - 1; i >= 0; --i) {
+        pending[i].tickets.removeAll(ticket);
+        if (pending[i].tickets.isEmpty()) pending.removeAt(i);
+    }
+}
+
+void SlideRenderer::dispatch()
+{
+    while (!pending.isEmpty()) {
+        int idleSlot = -1;
+        int idleCount = 0;
+        for (int i = 0; i < workers.size(); ++i) {
+            if (workers[i].busy) continue;
+            if (idleSlot < 0) idleSlot = i;
+            ++idleCount;
+        }
+        if (idleSlot < 0) return;
+
+        // Keep one worker free so a page turn never waits behind a prefetch
+        if (pending.first().priority == Priority::Prefetch && workers.size() > 1 && idleCount < 2) return;
+
+        startJob(idleSlot, pending.takeFirst());
+    }
+}
+
+void SlideRenderer::startJob(int slotIndex, const Job &job)
+{
+    WorkerSlot &slot = workers[slotIndex];
+    slot.busy = true;
+    slot.job = job;
+    slot.generation = generation;
+
+    RenderWorker *worker = slot.worker;
+    const RenderRequest request = job.request;
+    const QString path = sourcePath;
+    const quint64 jobGeneration = generation;
+    const std::shared_ptr<RasterDiskCache> disk = documentKey.isEmpty() ? nullptr : diskCache;
+    const QByteArray key = documentKey;
+    QMetaObject::invokeMethod(worker, [this, worker, slotIndex, request, path, jobGeneration, disk, key]() {
+        QImage image = disk ? disk->load(key, request) : QImage();
+        const bool rendered = image.isNull();
+        if (rendered) {
+            worker->ensureLoaded(path, jobGeneration);
+            image = worker->render(request);
+        }
+        QMetaObject::invokeMethod(this, [this, slotIndex, jobGeneration, image]() {
+            finishJob(slotIndex, jobGeneration, image);
+        }, Qt::QueuedConnection);
+        // Compressed off the render thread, so the next job does not wait for it
+        if (disk && rendered && !image.isNull()) {
+            QThreadPool::globalInstance()->start([disk, key, request, image]() { disk->store(key, request, image); });
+        }
+    }, Qt::QueuedConnection);
+}
+
+void SlideRenderer::finishJob(int slotIndex, quint64 jobGeneration, const QImage &image)
+{
+    WorkerSlot &slot = workers[slotIndex];
+    Job job = slot.job;
+    slot.busy = false;
+    slot.job = Job();
+
+    // Hand the freed worker its next job before listeners queue more work
+    dispatch();
+
+    if (jobGeneration != generation) return;
+    // A failed render still answers its tickets, with a null image
+    if (image.isNull()) {
+        for (quint64 ticket : job.tickets) {
+            emit imageReady(ticket, job.request, image);
+        }
+        return;
+    }
+    cache.insert(cacheKey(job.request), image);
+    // Rendered while the content hash is still running: written once the key arrives
+    if (diskCache && documentKey.isEmpty() && unkeyedRasters.size() < kUnkeyedRasters) {
+        unkeyedRasters.append(qMakePair(job.request, image));
+    }
+    for (quint64 ticket : job.tickets) {
+        emit imageReady(ticket, job.request, image);
+    }
+}
@@ -0,0 +1,215 @@
+#include "slidesorter.h"
+#include <QKeyEvent>
+#include <QScrollBar>
+
+namespace {
+const QSize kThumbnailSize(192, 108);
+const int kCellPadding = 12;                  // Around each thumbnail, room for the page number
+const int kThumbnailBudgetKb = 128 * 1024;    // Pixmaps kept by the model
+}
+
+SlideThumbnailModel::SlideThumbnailModel(SlideRenderer *renderer, QObject *parent)
+    : QAbstractListModel(parent), renderer(renderer), rows(renderer->pageCount()), devicePixelRatio(1.0),
+      splitView(false), thumbnails(kThumbnailBudgetKb)
+{
+    connect(renderer, &SlideRenderer::imageReady, this, &SlideThumbnailModel::onImageReady);
+    connect(renderer, &SlideRenderer::documentReady, this, &SlideThumbnailModel::reset);
+    connect(renderer, &SlideRenderer::loadFailed, this, &SlideThumbnailModel::reset);
+    setThumbnailSize(kThumbnailSize, 1.0);
+}
+
+void SlideThumbnailModel::setThumbnailSize(const QSize &box, qreal dpr)
+{
+    if (box == size && qFuzzyCompare(dpr, devicePixelRatio)) return;
+    size = box;
+    devicePixelRatio = dpr;
+    placeholder = QPixmap(size * dpr);
+    placeholder.setDevicePixelRatio(dpr);
+    placeholder.fill(QColor(0xdd, 0xdd, 0xdd));
+    reset();
+}
+
+void SlideThumbnailModel::setSplitMode(bool split)
+{
+    if (split == splitView) return;
+    splitView = split;
+    reset();
+}
+
+void SlideThumbnailModel::reset()
+{
+    beginResetModel();
+    cancelPending();
+    thumbnails.clear();
+    rows = renderer->pageCount();
+    endResetModel();
+}
+
+void SlideThumbnailModel::cancelPending()
+{
+    for (auto it = pending.constBegin(); it != pending.constEnd(); ++it) renderer->cancel(it.key());
+    pending.clear();
+    pendingPages.clear();
+}
+
+void SlideThumbnailModel::setVisibleRows(int first, int last)
+{
+    // Scrolling quickly through a long deck must not leave a queue of pages nobody sees
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (it.value() < first || it.value() > last) {
+            renderer->cancel(it.key());
+            pendingPages.remove(it.value());
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+int SlideThumbnailModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows;
+}
+
+RenderRequest SlideThumbnailModel::requestForPage(int page) const
+{
+    if (page < 0 || page >= renderer->pageCount()) return RenderRequest();
+    QRectF crop = splitView ? QRectF(0, 0, 0.5, 1) : QRectF(0, 0, 1, 1);
+    return RenderRequest::fitted(page, renderer->pagePointSize(page), size * devicePixelRatio, crop, devicePixelRatio);
+}
+
+QVariant SlideThumbnailModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= rows) return QVariant();
+    const int page = index.row();
+    if (role == Qt::DisplayRole) return QString::number(page + 1);
+    if (role == Qt::ToolTipRole) return QString("Slide %1").arg(page + 1);
+    if (role != Qt::DecorationRole) return QVariant();
+
+    if (QPixmap *pixmap = thumbnails.object(page)) return *pixmap;
+
+    // Asked for because it is being painted: use the shared cache, or render it now
+    const RenderRequest request = requestForPage(page);
+    if (!request.isValid()) return placeholder;
+    QImage cached = renderer->cachedImage(request);
+    if (!cached.isNull()) {
+        QPixmap pixmap = QPixmap::fromImage(cached);
+        thumbnails.insert(page, new QPixmap(pixmap), qMax<qsizetype>(1, cached.sizeInBytes() / 1024));
+        return pixmap;
+    }
+    if (!pendingPages.contains(page)) {
+        // Behind anything the audience or console asks for while the grid is open
+        const quint64 ticket = renderer->requestRender(request, SlideRenderer::Priority::Prefetch);
+        if (ticket) {
+            pending.insert(ticket, page);
+            pendingPages.insert(page, ticket);
+        }
+    }
+    return placeholder;
+}
+
+void SlideThumbnailModel::onImageReady(quint64 ticket, const RenderRequest &, const QImage &image)
+{
+    auto it = pending.find(ticket);
+    if (it == pending.end()) return;
+    const int page = it.value();
+    pending.erase(it);
+    pendingPages.remove(page);
+    if (image.isNull() || page >= rows) return;
+
+    thumbnails.insert(page, new QPixmap(QPixmap::fromImage(image)), qMax<qsizetype>(1, image.sizeInBytes() / 1024));
+    const QModelIndex changed = index(page);
+    emit dataChanged(changed, changed, { Qt::DecorationRole });
+}
+
+SlideSorter::SlideSorter(SlideRenderer *renderer, QWidget *parent)
+    : QListView(parent)
+{
+    thumbnails = new SlideThumbnailModel(renderer, this);
+    thumbnails->setThumbnailSize(kThumbnailSize, devicePixelRatio());
+    setModel(thumbnails);
+
+    // A fixed grid: positions are arithmetic, so even thousands of pages lay out instantly
+    setViewMode(QListView::IconMode);
+    setMovement(QListView::Static);
+    setResizeMode(QListView::Adjust);
+    setWrapping(true);
+    setUniformItemSizes(true);
+    setIconSize(kThumbnailSize);
+    setGridSize(kThumbnailSize + QSize(kCellPadding, kCellPadding + fontMetrics().height()));
+    setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
+    setSelectionMode(QAbstractItemView::SingleSelection);
+    setEditTriggers(QAbstractItemView::NoEditTriggers);
+    setStyleSheet("QListView { background: #333; color: #eee; }");
+
+    // Enter and Space are handled in keyPressEvent()
+    connect(this, &QListView::clicked, this, [this](const QModelIndex &index) { emit pageActivated(index.row()); });
+}
+
+void SlideSorter::setSplitMode(bool split)
+{
+    thumbnails->setSplitMode(split);
+}
+
+void SlideSorter::showPage(int page)
+{
+    thumbnails->setThumbnailSize(kThumbnailSize, devicePixelRatio()); // The window may have changed screens
+    const QModelIndex index = thumbnails->index(page);
+    if (!index.isValid()) return;
+    setCurrentIndex(index);
+    scrollTo(index, QAbstractItemView::PositionAtCenter);
+}
+
+bool SlideSorter::event(QEvent *event)
+{
+    // Keys the grid navigates with would otherwise turn slides through the global hotkeys
+    if (event->type() == QEvent::ShortcutOverride) {
+        switch (static_cast<QKeyEvent *>(event)->key()) {
+        case Qt::Key_Left: case Qt::Key_Right: case Qt::Key_Up: case Qt::Key_Down:
+        case Qt::Key_Home: case Qt::Key_End: case Qt::Key_PageUp: case Qt::Key_PageDown:
+        case Qt::Key_Space: case Qt::Key_Backspace: case Qt::Key_Escape:
+        case Qt::Key_Return: case Qt::Key_Enter:
+            event->accept();
+            return true;
+        }
+    }
+    return QListView::event(event);
+}
+
+void SlideSorter::keyPressEvent(QKeyEvent *event)
+{
+    switch (event->key()) {
+    case Qt::Key_Escape:
+        emit closeRequested();
+        return;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+    case Qt::Key_Space:
+        if (currentIndex().isValid()) emit pageActivated(currentIndex().row());
+        return;
+    }
+    QListView::keyPressEvent(event);
+}
+
+void SlideSorter::resizeEvent(QResizeEvent *event)
+{
+    QListView::resizeEvent(event);
+    updateVisibleRows();
+}
+
+void SlideSorter::scrollContentsBy(int dx, int dy)
+{
+    QListView::scrollContentsBy(dx, dy);
+    updateVisibleRows();
+}
+
+void SlideSorter::updateVisibleRows()
+{
+    // Rows on screen, plus one grid row of slack on either side
+    const QSize grid = gridSize();
+    if (grid.isEmpty()) return;
+    const int columns = qMax(1, viewport()->width() / grid.width());
+    const int top = verticalScrollBar()->value() / grid.height() - 1;
+    const int bottom = (verticalScrollBar()->value() + viewport()->height()) / grid.height() + 1;
+    thumbnails->setVisibleRows(top * columns, (bottom + 1) * columns - 1);
+}
@@ -0,0 +1,172 @@
+#include "strokeprocessor.h"
+#include <QLineF>
+#include <QList>
+#include <QPair>
+#include <QtMath>
+
+namespace {
+// Longest straight piece a smoothed curve is cut into
+const qreal kSmoothSegment = 4.0;
+const int kMaxSmoothSteps = 16;
+
+qreal dot(const QPointF &a, const QPointF &b)
+{
+    return a.x() * b.x() + a.y() * b.y();
+}
+
+// Distance from p to the segment a-b
+qreal segmentDistance(const QPointF &p, const QPointF &a, const QPointF &b)
+{
+    const QPointF ab = b - a;
+    const qreal lengthSquared = dot(ab, ab);
+    if (lengthSquared <= 0) return QLineF(p, a).length();
+    const qreal t = qBound<qreal>(0, dot(p - a, ab) / lengthSquared, 1);
+    return QLineF(p, a + t * ab).length();
+}
+
+// Direction of v relative to 'reference', in (-pi, pi]
+qreal relativeAngle(const QPointF &v, qreal reference)
+{
+    qreal angle = qAtan2(v.y(), v.x()) - reference;
+    while (angle > M_PI) angle -= 2 * M_PI;
+    while (angle <= -M_PI) angle += 2 * M_PI;
+    return angle;
+}
+}
+
+StrokeProcessor::StrokeProcessor()
+    : minDistance(2.0), simplifyTolerance(0.75), smoothing(false), runAngle(0), coneLow(-M_PI), coneHigh(M_PI)
+{
+    setAngleTolerance(4.0);
+}
+
+void StrokeProcessor::setAngleTolerance(qreal degrees)
+{
+    minCosine = qCos(qDegreesToRadians(degrees));
+}
+
+void StrokeProcessor::begin(const QPointF &point)
+{
+    live.clear();
+    live << point;
+}
+
+int StrokeProcessor::addPoint(const QPointF &point)
+{
+    if (live.isEmpty()) {
+        live << point;
+        return 0;
+    }
+
+    const QPointF last = live.last();
+    if (QLineF(last, point).length() < minDistance) return -1;
+
+    if (live.size() >= 2) {
+        // Still heading the same way: slide the end of the run instead of adding a vertex,
+        // as long as the vertex it replaces stays within the simplification tolerance
+        const QPointF prev = live[live.size() - 2];
+        const QPointF run = last - prev;
+        const QPointF step = point - last;
+        const qreal lengths = qSqrt(dot(run, run) * dot(step, step));
+        if (lengths > 0 && dot(run, step) / lengths >= minCosine
+            && segmentDistance(last, prev, point) <= simplifyTolerance) {
+            // So must every vertex the run replaced before: each one at distance d from
+            // prev admits chord directions within asin(tolerance / d) of its own, and
+            // the cone keeps the intersection of those, so gentle arcs end the run
+            qreal low = coneLow, high = coneHigh;
+            const qreal reach = qSqrt(dot(run, run));
+            if (reach > simplifyTolerance) {
+                const qreal spread = qAsin(simplifyTolerance / reach);
+                const qreal angle = relativeAngle(run, runAngle);
+                low = qMax(low, angle - spread);
+                high = qMin(high, angle + spread);
+            }
+            const qreal chord = relativeAngle(point - prev, runAngle);
+            if (chord >= low && chord <= high) {
+                coneLow = low;
+                coneHigh = high;
+                live.last() = point;
+                return live.size() - 2;
+            }
+        }
+    }
+
+    live << point;
+    startRun();
+    return live.size() - 2;
+}
+
+void StrokeProcessor::startRun()
+{
+    const QPointF run = live.last() - live[live.size() - 2];
+    runAngle = qAtan2(run.y(), run.x());
+    coneLow = -M_PI;
+    coneHigh = M_PI;
+}
+
+QPolygonF StrokeProcessor::finish()
+{
+    QPolygonF result = simplify(live, simplifyTolerance);
+    if (smoothing) result = smooth(result, kSmoothSegment);
+    live.clear();
+    return result;
+}
+
+QPolygonF StrokeProcessor::simplify(const QPolygonF &points, qreal tolerance)
+{
+    const int n = points.size();
+    if (n < 3 || tolerance <= 0) return points;
+
+    // Douglas-Peucker with an explicit stack; long strokes would recurse deeply
+    QList<bool> keep(n, false);
+    keep[0] = keep[n - 1] = true;
+    QList<QPair<int, int>> ranges;
+    ranges.append(qMakePair(0, n - 1));
+    while (!ranges.isEmpty()) {
+        const QPair<int, int> range = ranges.takeLast();
+        qreal farthest = 0;
+        int index = -1;
+        for (int i = range.first + 1; i < range.second; ++i) {
+            qreal d = segmentDistance(points[i], points[range.first], points[range.second]);
+            if (d > farthest) {
+                farthest = d;
+                index = i;
+            }
+        }
+        if (index < 0 || farthest <= tolerance) continue;
+        keep[index] = true;
+        ranges.append(qMakePair(range.first, index));
+        ranges.append(qMakePair(index, range.second));
+    }
+
+    QPolygonF result;
+    for (int i = 0; i < n; ++i) {
+        if (keep[i]) result << points[i];
+    }
+    return result;
+}
+
+QPolygonF StrokeProcessor::smooth(const QPolygonF &points, qreal maxSegment)
+{
+    const int n = points.size();
+    if (n < 3 || maxSegment <= 0) return points;
+
+    // Uniform Catmull-Rom through every vertex; end points are repeated as tangents
+    QPolygonF result;
+    result << points[0];
+    for (int i = 0; i < n - 1; ++i) {
+        const QPointF p0 = points[qMax(0, i - 1)];
+        const QPointF p1 = points[i];
+        const QPointF p2 = points[i + 1];
+        const QPointF p3 = points[qMin(n - 1, i + 2)];
+        const int steps = qBound(1, qCeil(QLineF(p1, p2).length() / maxSegment), kMaxSmoothSteps);
+        for (int s = 1; s <= steps; ++s) {
+            const qreal t = qreal(s) / steps;
+            const qreal t2 = t * t;
+            const qreal t3 = t2 * t;
+            result << 0.5 * ((2 * p1) + (p2 - p0) * t + (2 * p0 - 5 * p1 + 4 * p2 - p3) * t2
+                             + (3 * p1 - p0 - 3 * p2 + p3) * t3);
+        }
+    }
+    return result;
+}